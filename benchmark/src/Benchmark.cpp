@@ -0,0 +1,199 @@
+#include "Benchmark.h"
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <regex>
+#include <map>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+typedef std::chrono::steady_clock Clock;
+
+//--------------------------------------------------------------
+static double seconds(Clock::duration d) {
+	return std::chrono::duration<double>(d).count();
+}
+
+//--------------------------------------------------------------
+void Benchmark::add(const std::string & name, std::function<void()> run) {
+	cases.push_back({ name, run });
+}
+
+//--------------------------------------------------------------
+void Benchmark::run(const std::string & filter) {
+	results.clear();
+	for (auto & c : cases) {
+		if (!filter.empty() && c.name.find(filter) == std::string::npos)
+			continue;
+		results.push_back(measure(c));
+		auto & r = results.back();
+		printf("%-48s %14.1f ns %14.1f ns min %10zu it\n", r.name.c_str(), r.median, r.min, r.iterations);
+		fflush(stdout);
+	}
+}
+
+//--------------------------------------------------------------
+Benchmark::Result Benchmark::measure(Case & c) {
+
+	// Warm up caches and lazily built state, then size batches to about a millisecond
+	c.run();
+	size_t batch = 1;
+	for (;;) {
+		Clock::time_point start = Clock::now();
+		for (size_t i = 0; i < batch; i++)
+			c.run();
+		if (seconds(Clock::now() - start) >= 0.001 || batch >= (1 << 24))
+			break;
+		batch *= 2;
+	}
+
+	std::vector<double> times;
+	Clock::time_point begin = Clock::now();
+	while (times.size() < minBatches || seconds(Clock::now() - begin) < minTime) {
+		Clock::time_point start = Clock::now();
+		for (size_t i = 0; i < batch; i++)
+			c.run();
+		times.push_back(seconds(Clock::now() - start) * 1e9 / batch);
+	}
+
+	Result r;
+	r.name = c.name;
+	r.iterations = times.size() * batch;
+	std::sort(times.begin(), times.end());
+	r.median = times[times.size() / 2];
+	r.min = times.front();
+	for (double t : times)
+		r.mean += t;
+	r.mean /= times.size();
+	return r;
+}
+
+//--------------------------------------------------------------
+const std::vector<Benchmark::Result> & Benchmark::getResults() const {
+	return results;
+}
+
+//--------------------------------------------------------------
+static std::string quote(const std::string & s) {
+	std::string q = "\"";
+	for (char c : s) {
+		if (c == '"' || c == '\\')
+			q += '\\';
+		q += c;
+	}
+	return q + "\"";
+}
+
+//--------------------------------------------------------------
+static std::string unquote(const std::string & s) {
+	std::string u;
+	for (size_t i = 0; i < s.size(); i++) {
+		if (s[i] == '\\' && i + 1 < s.size())
+			i++;
+		u += s[i];
+	}
+	return u;
+}
+
+//--------------------------------------------------------------
+bool Benchmark::save(const std::string & filePath) const {
+	std::ofstream file(filePath);
+	if (!file) {
+		fprintf(stderr, "Unable to write %s\n", filePath.c_str());
+		return false;
+	}
+
+	file.precision(17);
+	file << "{\n\t\"benchmarks\": [";
+	for (size_t i = 0; i < results.size(); i++) {
+		auto & r = results[i];
+		file << (i ? ",\n" : "\n") << "\t\t{\n"
+			<< "\t\t\t\"iterations\": " << r.iterations << ",\n"
+			<< "\t\t\t\"mean\": " << r.mean << ",\n"
+			<< "\t\t\t\"median\": " << r.median << ",\n"
+			<< "\t\t\t\"min\": " << r.min << ",\n"
+			<< "\t\t\t\"name\": " << quote(r.name) << "\n"
+			<< "\t\t}";
+	}
+	file << "\n\t],\n\t\"unit\": \"ns\"\n}" << std::endl;
+	return true;
+}
+
+//--------------------------------------------------------------
+bool Benchmark::compare(const std::string & baselinePath, double threshold) const {
+	std::ifstream file(baselinePath);
+	if (!file) {
+		fprintf(stderr, "Unable to read %s\n", baselinePath.c_str());
+		return false;
+	}
+	std::stringstream text;
+	text << file.rdbuf();
+	std::string json = text.str();
+
+	// Only the name and median of each case object are needed, as written by save()
+	std::map<std::string, double> baseline;
+	std::regex object("\\{[^{}]*\\}");
+	std::regex name("\"name\"\\s*:\\s*\"((?:[^\"\\\\]|\\\\.)*)\"");
+	std::regex median("\"median\"\\s*:\\s*([-+0-9.eE]+)");
+	for (std::sregex_iterator it(json.begin(), json.end(), object), end; it != end; ++it) {
+		std::string o = it->str();
+		std::smatch n, m;
+		if (std::regex_search(o, n, name) && std::regex_search(o, m, median))
+			baseline[unquote(n[1].str())] = atof(m[1].str().c_str());
+	}
+	if (baseline.empty()) {
+		fprintf(stderr, "Invalid baseline %s: no benchmarks\n", baselinePath.c_str());
+		return false;
+	}
+	bool passed = true;
+	printf("\n%-48s %14s %14s %9s\n", "Compared to baseline", "baseline ns", "ns", "change");
+	for (auto & r : results) {
+		auto it = baseline.find(r.name);
+		if (it == baseline.end() || it->second <= 0) {
+			printf("%-48s %14s %14.1f %9s\n", r.name.c_str(), "-", r.median, "new");
+			continue;
+		}
+		double change = r.median / it->second - 1;
+		bool regressed = change > threshold;
+		if (regressed)
+			passed = false;
+		printf("%-48s %14.1f %14.1f %+8.1f%%%s\n", r.name.c_str(), it->second, r.median, change * 100, regressed ? "  REGRESSION" : "");
+	}
+	return passed;
+}
+
+//--------------------------------------------------------------
+int Benchmark::main(int argc, char ** argv) {
+	std::string filter;
+	std::string jsonPath;
+	std::string baselinePath;
+	double threshold = 0.1;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--filter" && hasValue)
+			filter = argv[++i];
+		else if (arg == "--json" && hasValue)
+			jsonPath = argv[++i];
+		else if (arg == "--baseline" && hasValue)
+			baselinePath = argv[++i];
+		else if (arg == "--threshold" && hasValue)
+			threshold = atof(argv[++i]);
+		else if (arg == "--min-time" && hasValue)
+			minTime = atof(argv[++i]);
+		else {
+			printf("Usage: %s [--filter name] [--json results.json] [--baseline baseline.json] [--threshold 0.1] [--min-time 0.5]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	run(filter);
+
+	if (!jsonPath.empty() && !save(jsonPath))
+		return 2;
+	if (!baselinePath.empty() && !compare(baselinePath, threshold))
+		return 1;
+	return 0;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+
+// Minimal benchmark runner. Each case is timed in batches until a minimum time has passed
+// and reported as nanoseconds per iteration, the median over batches being the figure
+// compared against a baseline. Only needs the standard library, so it also builds with
+// ofxMapperCore alone.
+class Benchmark {
+public:
+	struct Result {
+		std::string name;
+		double median = 0;
+		double min = 0;
+		double mean = 0;
+		size_t iterations = 0;
+	};
+
+	// One iteration of the measured code, setup belongs outside
+	void add(const std::string & name, std::function<void()> run);
+
+	// Run cases whose name contains filter, an empty filter runs all
+	void run(const std::string & filter = "");
+	const std::vector<Result> & getResults() const;
+
+	bool save(const std::string & filePath) const;
+	// Print the change against each case in the baseline and return false if any
+	// median got slower by more than threshold, e.g. 0.1 for 10%
+	bool compare(const std::string & baselinePath, double threshold) const;
+
+	// Parse the command line, run, then save and compare as asked. Returns the exit code,
+	// 1 for a regression and 2 for bad arguments or files.
+	int main(int argc, char ** argv);
+
+	// Time spent per case
+	double minTime = 0.5;
+	size_t minBatches = 5;
+
+private:
+	struct Case {
+		std::string name;
+		std::function<void()> run;
+	};
+
+	Result measure(Case & c);
+
+	std::vector<Case> cases;
+	std::vector<Result> results;
+};
@@ -0,0 +1,123 @@
+#include "CoreCases.h"
+#include "Bezier.h"
+#include "BezierPatch.h"
+#include "ScanlineRasterizer.h"
+#include "DistanceField.h"
+#include "CompositionCache.h"
+#include <cmath>
+#include <cstdio>
+
+using namespace ofxMapper;
+
+static const float pi = 3.14159265358979f;
+
+//--------------------------------------------------------------
+VerticesPtr makeGrid(size_t cols, size_t rows, float width, float height) {
+	size_t w = cols * 3 + 1;
+	size_t h = rows * 3 + 1;
+	VerticesPtr vertices(new Vertices(w, h));
+	for (size_t y = 0; y < h; y++) {
+		for (size_t x = 0; x < w; x++) {
+			float u = x / float(w - 1);
+			float v = y / float(h - 1);
+			vertices->data[y * w + x] = glm::vec2(
+				u * width + std::sin(v * pi) * width * 0.02f,
+				v * height + std::sin(u * pi) * height * 0.02f);
+		}
+	}
+	return vertices;
+}
+
+//--------------------------------------------------------------
+static std::vector<glm::vec2> makeOutline(size_t points) {
+	// Wavy outline, concave so fills and distances have work to do
+	std::vector<glm::vec2> outline;
+	for (size_t i = 0; i < points; i++) {
+		float angle = 2 * pi * i / points;
+		float radius = 400 + 60 * std::sin(angle * 7);
+		outline.push_back(glm::vec2(960 + std::cos(angle) * radius, 540 + std::sin(angle) * radius));
+	}
+	return outline;
+}
+
+//--------------------------------------------------------------
+static void addBezierCases(Benchmark & benchmark) {
+	for (size_t resolution : { 10, 20, 40 }) {
+		auto bezier = std::make_shared<Bezier>(glm::vec2(0, 0), glm::vec2(300, -100), glm::vec2(700, 100), glm::vec2(1000, 0));
+		benchmark.add("Bezier/setResolution/" + std::to_string(resolution), [=]() {
+			bezier->setResolution(resolution);
+		});
+	}
+
+	for (size_t subdivisions : { 5, 10, 20 }) {
+		// One patch set up like BezierWarper::updatePatches
+		auto patch = std::make_shared<BezierPatch>();
+		VerticesPtr grid = makeGrid(1, 1, 1920, 1080);
+		glm::vec2 * v = grid->data;
+		for (size_t i = 0; i < 4; i++) {
+			size_t a = grid->width * i;
+			patch->bezierRows[i].set(v[a], v[a + 1], v[a + 2], v[a + 3], 20);
+			size_t b = i;
+			patch->bezierCols[i].set(v[b], v[b + grid->width], v[b + grid->width * 2], v[b + grid->width * 3], 20);
+		}
+		benchmark.add("BezierPatch/subdivide/" + std::to_string(subdivisions), [=]() {
+			patch->subdivide(subdivisions, subdivisions);
+		});
+	}
+}
+
+//--------------------------------------------------------------
+static void addCoverageCases(Benchmark & benchmark) {
+	for (size_t points : { 64, 256 }) {
+		auto contours = std::make_shared<std::vector<std::vector<glm::vec2>>>(1, makeOutline(points));
+		auto rasterizer = std::make_shared<ScanlineRasterizer>();
+		auto coverage = std::make_shared<std::vector<unsigned char>>(1920 * 1080);
+		benchmark.add("ScanlineRasterizer/fill/" + std::to_string(points), [=]() {
+			rasterizer->fill(*contours, ScanlineRasterizer::FILL_ODD, 1920, 1080, coverage->data());
+		});
+
+		auto field = std::make_shared<DistanceField>();
+		benchmark.add("DistanceField/compute/" + std::to_string(points), [=]() {
+			field->compute(*contours, 1920, 1080, 20);
+		});
+	}
+}
+
+//--------------------------------------------------------------
+static void addCacheCases(Benchmark & benchmark) {
+	// Four screens of 32 bezier slices on 4x4 grids
+	auto screens = std::make_shared<std::vector<ScreenData>>(4);
+	for (auto & screen : *screens) {
+		screen.uniqueId = UniqueId::create();
+		for (size_t i = 0; i < 32; i++) {
+			SliceData slice;
+			slice.uniqueId = UniqueId::create();
+			slice.inputRect.set(i * 60.f, 0, 60, 1080);
+			slice.bezierEnabled = true;
+			VerticesPtr grid = makeGrid(4, 4, 1920, 1080);
+			slice.controlWidth = grid->width;
+			slice.controlHeight = grid->height;
+			slice.vertices.assign(grid->data, grid->data + grid->width * grid->height);
+			screen.slices.push_back(slice);
+		}
+	}
+
+	std::string path = "benchmark.cache";
+	if (!CompositionCache::write(path, 1, Rect(0, 0, 7680, 1080), *screens)) {
+		fprintf(stderr, "Unable to write %s, skipping cache cases\n", path.c_str());
+		return;
+	}
+	benchmark.add("CompositionCache/read", [=]() {
+		CompositionCache cache;
+		std::vector<ScreenData> data;
+		if (cache.open(path, 1))
+			cache.read(data);
+	});
+}
+
+//--------------------------------------------------------------
+void addCoreCases(Benchmark & benchmark) {
+	addBezierCases(benchmark);
+	addCoverageCases(benchmark);
+	addCacheCases(benchmark);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "Vertices.h"
+
+// Cases for the code in ofxMapperCore, shared by the openFrameworks benchmark and the
+// one built with CMake
+
+// Control points for cols x rows patches, slightly bent so curves don't degenerate to lines
+VerticesPtr makeGrid(size_t cols, size_t rows, float width, float height);
+
+void addCoreCases(Benchmark & benchmark);
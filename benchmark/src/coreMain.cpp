@@ -0,0 +1,11 @@
+#include "CoreCases.h"
+
+// The ofxMapperCore cases on their own, built with CMake without openFrameworks.
+// Takes the same arguments as the openFrameworks benchmark.
+
+//========================================================================
+int main(int argc, char ** argv) {
+	Benchmark benchmark;
+	addCoreCases(benchmark);
+	return benchmark.main(argc, argv);
+}
@@ -0,0 +1,93 @@
+#include "ofMain.h"
+#include "ofxMapper.h"
+#include "CoreCases.h"
+
+using namespace ofxMapper;
+
+// Geometry benchmarks, run without a window or GL context. The ofxMapperCore cases are
+// also built on their own with CMake, see coreMain.cpp.
+//
+//   benchmark [--filter name] [--json results.json] [--baseline baseline.json]
+//             [--threshold 0.1] [--min-time 0.5]
+//
+// Exits with 1 when a case got slower than the baseline by more than the threshold.
+
+//--------------------------------------------------------------
+static void addWarperCases(Benchmark & benchmark) {
+	for (size_t grid : { 1, 2, 4 }) {
+		for (int subdivisions : { 5, 10, 20 }) {
+			auto warper = make_shared<BezierWarper>();
+			warper->adaptive = false;
+			warper->subCols = subdivisions;
+			warper->subRows = subdivisions;
+			warper->setVertices(makeGrid(grid, grid, 1920, 1080));
+			benchmark.add("BezierWarper/updatePatches/" + ofToString(grid) + "x" + ofToString(grid) + "/" + ofToString(subdivisions), [=]() {
+				warper->updatePatches();
+			});
+		}
+	}
+
+	// makeMesh is private, updatePatches is the smallest public step that rebuilds the mesh
+	for (size_t grid : { 1, 4, 16 }) {
+		auto warper = make_shared<LinearWarper>();
+		warper->setVertices(makeGrid(grid, grid, 1920, 1080));
+		benchmark.add("LinearWarper/updatePatches/" + ofToString(grid) + "x" + ofToString(grid), [=]() {
+			warper->updatePatches();
+		});
+	}
+}
+
+//--------------------------------------------------------------
+static void addMaskCases(Benchmark & benchmark) {
+	for (size_t points : { 16, 64, 256 }) {
+		for (float feather : { 0.f, 20.f }) {
+			// Wavy outline, concave so the tessellator has work to do
+			MaskData data;
+			data.feather = feather;
+			for (size_t i = 0; i < points; i++) {
+				float angle = TWO_PI * i / points;
+				float radius = 400 + 60 * sin(angle * 7);
+				data.points.push_back(glm::vec2(960 + cos(angle) * radius, 540 + sin(angle) * radius));
+			}
+			auto mask = make_shared<Mask>();
+			mask->set(data, ofRectangle(0, 0, 1920, 1080));
+			benchmark.add("Mask/updateMesh/" + ofToString(points) + "/feather" + ofToString(feather), [=]() {
+				mask->updateMesh();
+			});
+		}
+	}
+}
+
+//--------------------------------------------------------------
+static void addMapperCases(Benchmark & benchmark) {
+	const size_t numScreens = 4;
+	for (size_t slices : { 8, 32, 128 }) {
+		// Soft edged slices side by side, each overlapping its neighbours
+		vector<ScreenData> data(numScreens);
+		size_t perScreen = slices / numScreens;
+		for (size_t i = 0; i < numScreens; i++) {
+			for (size_t j = 0; j < perScreen; j++) {
+				SliceData slice;
+				slice.softEdgeEnabled = true;
+				slice.inputRect.set((i * perScreen + j) * 200.f, 0, 260, 1080);
+				data[i].slices.push_back(slice);
+			}
+		}
+		auto mapper = make_shared<Mapper>();
+		mapper->setHeadless(true);
+		mapper->loadScreens(data);
+		benchmark.add("Mapper/updateBlendRects/" + ofToString(slices), [=]() {
+			mapper->updateBlendRects();
+		});
+	}
+}
+
+//========================================================================
+int main(int argc, char ** argv) {
+	Benchmark benchmark;
+	addCoreCases(benchmark);
+	addWarperCases(benchmark);
+	addMaskCases(benchmark);
+	addMapperCases(benchmark);
+	return benchmark.main(argc, argv);
+}
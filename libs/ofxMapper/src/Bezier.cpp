@@ -160,3 +160,12 @@ glm::vec2 Bezier::getPointAtPercent(float f) {
     }
     return vertices[n-1];
 }
+
+size_t Bezier::getMemoryUsage() const {
+	return vertices.capacity() * sizeof(glm::vec2) + distances.capacity() * sizeof(float);
+}
+
+void Bezier::compact() {
+	vertices.shrink_to_fit();
+	distances.shrink_to_fit();
+}
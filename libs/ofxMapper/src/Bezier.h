@@ -74,6 +74,10 @@ public:
 
     glm::vec2 getPointAtPercent(float f);
 
+	// Heap bytes of the vertex and distance tables, by capacity
+	size_t getMemoryUsage() const;
+	void compact();
+
 protected:
     glm::vec2 a;
     glm::vec2 b;
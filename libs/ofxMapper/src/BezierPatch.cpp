@@ -166,3 +166,34 @@ void BezierPatch::makeSubdiv(Bezier & a1, Bezier & a2, Bezier & b1, Bezier & b2,
 		}
 	}
 }
+
+//--------------------------------------------------------------
+size_t BezierPatch::getMemoryUsage() const {
+	size_t n = (bezierSubRows.capacity() + bezierSubCols.capacity()) * sizeof(Bezier);
+	for (size_t i = 0; i < 4; i++) {
+		n += bezierRows[i].getMemoryUsage() + bezierCols[i].getMemoryUsage();
+	}
+	for (auto & b : bezierSubRows) {
+		n += b.getMemoryUsage();
+	}
+	for (auto & b : bezierSubCols) {
+		n += b.getMemoryUsage();
+	}
+	return n;
+}
+
+//--------------------------------------------------------------
+void BezierPatch::compact() {
+	for (size_t i = 0; i < 4; i++) {
+		bezierRows[i].compact();
+		bezierCols[i].compact();
+	}
+	bezierSubRows.shrink_to_fit();
+	bezierSubCols.shrink_to_fit();
+	for (auto & b : bezierSubRows) {
+		b.compact();
+	}
+	for (auto & b : bezierSubCols) {
+		b.compact();
+	}
+}
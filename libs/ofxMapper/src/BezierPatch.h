@@ -1,6 +1,5 @@
 #pragma once
 
-#include "Warper.h"
 #include "Bezier.h"
 #include <vector>
 
@@ -24,6 +23,10 @@ public:
 	unsigned int meshIndices(unsigned int * indices, unsigned int start = 0);
 	unsigned int meshIndices(std::vector<unsigned int> & indices, unsigned int start = 0);
 
+	// Heap bytes of all curves, the patch itself not included
+	size_t getMemoryUsage() const;
+	void compact();
+
 	Bezier bezierRows[4];
 	Bezier bezierCols[4];
 
@@ -1,4 +1,5 @@
 #include "BezierWarper.h"
+#include "Profiler.h"
 #include "ColorCorrect.h"
 
 #define STR(a) #a
@@ -52,6 +53,19 @@ void BezierWarper::setVertices(VerticesPtr v) {
 	updatePatches();
 }
 
+//--------------------------------------------------------------
+void BezierWarper::clear() {
+	vertices.reset();
+	cols = 0;
+	rows = 0;
+	patches.clear();
+	outline.clear();
+	outlineBounds = ofRectangle();
+	mesh.clear();
+	clearHandles();
+	dirty = false;
+}
+
 //--------------------------------------------------------------
 VerticesPtr BezierWarper::subdivide(int subdivCols, int subdivRows) {
 
@@ -175,6 +189,8 @@ VerticesPtr BezierWarper::subdivide(int subdivCols, int subdivRows) {
 
 //--------------------------------------------------------------
 void BezierWarper::updatePatches() {
+	TraceScope trace("BezierWarper::updatePatches", "geometry");
+	dirty = false;
 
     patches.resize(rows * cols);
 
@@ -295,6 +311,7 @@ void BezierWarper::makeOutline() {
 		rowIndex -= cols;
 	}
 	outline.close();
+	outlineBounds = outline.getBoundingBox();
 }
 
 //--------------------------------------------------------------
@@ -384,6 +401,7 @@ void BezierWarper::drawOutline() {
 //--------------------------------------------------------------
 void BezierWarper::drawMesh() {
     getShader().begin();
+	ofxMapper::Profiler::countMesh(mesh);
 	mesh.draw();
     getShader().end();
 }
@@ -433,7 +451,7 @@ void BezierWarper::drawBeziers(vector<Bezier> & beziers) {
 
 //--------------------------------------------------------------
 bool BezierWarper::select(const glm::vec2 & p) {
-	return outline.size() && outline.inside(ofPoint(p));
+	return outline.size() && outlineBounds.inside(p.x, p.y) && outline.inside(ofPoint(p));
 }
 
 //--------------------------------------------------------------
@@ -443,12 +461,35 @@ void BezierWarper::moveHandle(WarpHandle & handle, const glm::vec2 & delta) {
 	for (auto & h : handles) {
 		moveHandle(h, delta);
 	}
+	invalidateHandleIndex();
 	notifyHandles();
 }
 
+//--------------------------------------------------------------
+void BezierWarper::getMemoryUsage(ofxMapper::MemoryUsage & usage) const {
+	usage.cpu[ofxMapper::MEMORY_CURVES] += patches.capacity() * sizeof(BezierPatch);
+	for (auto & patch : patches) {
+		usage.cpu[ofxMapper::MEMORY_CURVES] += patch.getMemoryUsage();
+	}
+	usage.cpu[ofxMapper::MEMORY_MESHES] += ofxMapper::getCapacityBytes(mesh) + ofxMapper::getCapacityBytes(outline);
+	usage.cpu[ofxMapper::MEMORY_HANDLES] += getHandleMemoryUsage();
+}
+
+//--------------------------------------------------------------
+void BezierWarper::compact() {
+	patches.shrink_to_fit();
+	for (auto & patch : patches) {
+		patch.compact();
+	}
+	ofxMapper::shrinkToFit(mesh);
+	ofxMapper::shrinkToFit(outline);
+	compactHandles();
+}
+
 //--------------------------------------------------------------
 void BezierWarper::clearHandles() {
 	handles.clear();
+	invalidateHandleIndex();
 }
 
 //--------------------------------------------------------------
@@ -463,6 +504,7 @@ void BezierWarper::addHandle(WarpHandle * parent, int x, int y) {
 //--------------------------------------------------------------
 void BezierWarper::updateHandles(vector<WarpHandle>& warpHandles) {
 	handles.clear();
+	invalidateHandleIndex();
 
 	for (auto & handle : warpHandles) {
 		if (handle.selected) {
@@ -507,7 +549,12 @@ void BezierWarper::moveHandle(ControlHandle & handle, const glm::vec2 & delta) {
 
 //--------------------------------------------------------------
 void BezierWarper::notifyHandles() {
-	updatePatches();
+	dirty = true;
+}
+
+//--------------------------------------------------------------
+bool BezierWarper::isDirty() const {
+	return dirty;
 }
 
 //--------------------------------------------------------------
@@ -583,14 +630,14 @@ vector<glm::vec2> BezierWarper::getControls(BezierHandle & handle) {
 
 //--------------------------------------------------------------
 void BezierWarper::adaptiveBezierChanged(int &) {
-    if (adaptive) {
+    if (adaptive && vertices) {
 		updatePatches();
     }
 }
 
 //--------------------------------------------------------------
 void BezierWarper::adaptiveSubChanged(int &) {
-    if (adaptive) {
+    if (adaptive && vertices) {
         makeSub();
     }
 }
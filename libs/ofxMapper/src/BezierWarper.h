@@ -30,6 +30,7 @@ public:
 	void setVertices(VerticesPtr vertices);
     
     VerticesPtr subdivide(int cols, int rows);
+	void clear();
 
     void updatePatches();
     void updateTexCoords();
@@ -47,11 +48,16 @@ public:
 
 	void moveHandle(WarpHandle & handle, const glm::vec2 & delta);
 
+	void getMemoryUsage(ofxMapper::MemoryUsage & usage) const;
+	void compact();
+
 	void clearHandles();
 	void addHandle(WarpHandle * parent, int x, int y);
 	void updateHandles(vector<WarpHandle> & handles);
 	void moveHandle(ControlHandle & handle, const glm::vec2 & delta);
+	// Control handle edits only mark the patches dirty, rebuilt by the next updatePatches
 	void notifyHandles();
+	bool isDirty() const;
 
 	using HasHandlesT<ControlHandle>::moveHandle;
 
@@ -84,6 +90,8 @@ private:
     vector<BezierPatch> patches;
 
 	ofPolyline outline;
+	bool dirty = false;
+	ofRectangle outlineBounds;
 
     ofMesh mesh;
     static ofShader shader;
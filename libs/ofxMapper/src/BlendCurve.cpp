@@ -0,0 +1,55 @@
+#include "BlendCurve.h"
+#include <cmath>
+#include <algorithm>
+
+constexpr float BlendCurve::maxError;
+
+//--------------------------------------------------------------
+BlendCurve::BlendCurve(float power, float luminance, float gamma) : power(power), luminance(luminance), gamma(gamma) {
+	values.resize(size);
+	for (size_t i = 0; i < size; i++) {
+		values[i] = evaluate((float)i / (size - 1));
+	}
+
+	// Check between the entries, with a margin for peaks falling between the probes
+	const int probes = 4;
+	for (size_t i = 0; i + 1 < size && tabulated; i++) {
+		for (int j = 1; j < probes; j++) {
+			float x = (i + (float)j / probes) / (size - 1);
+			if (std::fabs(interpolate(x) - evaluate(x)) > maxError * 0.5f) {
+				tabulated = false;
+				break;
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------
+float BlendCurve::evaluate(float x, float p, float a, float gamma) {
+	float f;
+	if (x < 0.5f)
+		f = a * powf(2.f * x, p);
+	else
+		f = 1.f - (1.f - a) * powf(2.f * (1.f - x), p);
+	return powf(f, 1.f / gamma);
+}
+
+//--------------------------------------------------------------
+float BlendCurve::evaluate(float x) const {
+	return evaluate(std::min(std::max(x, 0.f), 1.f), power, luminance, gamma);
+}
+
+//--------------------------------------------------------------
+float BlendCurve::lookup(float x) const {
+	return tabulated ? interpolate(x) : evaluate(x);
+}
+
+//--------------------------------------------------------------
+float BlendCurve::interpolate(float x) const {
+	float f = std::min(std::max(x, 0.f), 1.f) * (size - 1);
+	size_t i = (size_t)f;
+	if (i >= size - 1)
+		return values[size - 1];
+	float w = f - i;
+	return values[i] + (values[i + 1] - values[i]) * w;
+}
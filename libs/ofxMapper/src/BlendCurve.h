@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// Soft edge blend function, tabulated for linear interpolation over [0, 1]. Curves the
+// table can't follow within maxError, e.g. powers below 1 with their infinite slope at
+// both ends, are marked as not tabulated and evaluated exactly instead.
+class BlendCurve {
+public:
+	// Odd size puts the curve midpoint (x = 0.5) exactly on an entry
+	static const size_t size = 1025;
+	static constexpr float maxError = 1.f / 1024;
+
+	BlendCurve(float power, float luminance, float gamma);
+
+	static float evaluate(float x, float power, float luminance, float gamma);
+	float evaluate(float x) const;
+
+	// Within maxError of evaluate()
+	float lookup(float x) const;
+	bool isTabulated() const { return tabulated; }
+	const std::vector<float> & getValues() const { return values; }
+
+	float getPower() const { return power; }
+	float getLuminance() const { return luminance; }
+	float getGamma() const { return gamma; }
+
+private:
+	float interpolate(float x) const;
+
+	float power;
+	float luminance;
+	float gamma;
+
+	std::vector<float> values;
+	bool tabulated = true;
+};
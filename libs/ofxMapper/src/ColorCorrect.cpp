@@ -1,4 +1,5 @@
 #include "ColorCorrect.h"
+#include "Profiler.h"
 
 #define STR(a) #a
 
@@ -16,26 +17,57 @@ STR(
         color.b *= gainBlue;
         color += brightness;
         color = ((color - 0.5) * (contrast + 1.0)) + 0.5;
-        return color;
+        return colorLookup(color);
     }
     );
 
 string ColorCorrect::getShaderSource() {
-    return colorFrag;
+    return ColorLut::getShaderSource() + colorFrag;
 }
 
-void ColorCorrect::setUniforms(const ofShader &shader) {
+void ColorCorrect::setUniforms(const ofShader &shader, const ColorLutPtr & screenLut) {
     shader.setUniform1f("gainRed", gainRed / 100.f + 1.f);
     shader.setUniform1f("gainGreen", gainGreen / 100.f + 1.f);
     shader.setUniform1f("gainBlue", gainBlue / 100.f + 1.f);
     shader.setUniform1f("brightness", brightness / 100.f);
     shader.setUniform1f("contrast", contrast / 100.f);
+    ofxMapper::Profiler::count(ofxMapper::COUNTER_UNIFORMS, 5);
+    setLutUniforms(shader, lut ? lut : screenLut);
 }
 
-void ColorCorrect::setUniformsZero(const ofShader &shader) {
+void ColorCorrect::setUniformsZero(const ofShader &shader, const ColorLutPtr & screenLut) {
     shader.setUniform1f("gainRed", 1);
     shader.setUniform1f("gainGreen", 1);
     shader.setUniform1f("gainBlue", 1);
     shader.setUniform1f("brightness", 0);
     shader.setUniform1f("contrast", 0);
+    ofxMapper::Profiler::count(ofxMapper::COUNTER_UNIFORMS, 5);
+    setLutUniforms(shader, screenLut);
+}
+
+void ColorCorrect::setLutUniforms(const ofShader &shader, const ColorLutPtr & lut) {
+    if (lut)
+        lut->setUniforms(shader);
+    else
+        ColorLut::setUniformsZero(shader);
+}
+
+bool ColorCorrect::loadLut(string filePath) {
+    ColorLutPtr l(new ColorLut);
+    if (!l->load(filePath))
+        return false;
+    lut = l;
+    return true;
+}
+
+void ColorCorrect::setLut(ColorLutPtr l) {
+    lut = l;
+}
+
+ColorLutPtr ColorCorrect::getLut() const {
+    return lut;
+}
+
+void ColorCorrect::clearLut() {
+    lut.reset();
 }
@@ -1,14 +1,23 @@
 #pragma once
 
 #include "ofMain.h"
+#include "ColorLut.h"
 
 class ColorCorrect {
 public:
 
     static string getShaderSource();
 
-    void setUniforms(const ofShader & shader);
-    void setUniformsZero(const ofShader & shader);
+    // Screen lut is used when no lut is set on this color correction
+    void setUniforms(const ofShader & shader, const ColorLutPtr & screenLut = ColorLutPtr());
+    void setUniformsZero(const ofShader & shader, const ColorLutPtr & screenLut = ColorLutPtr());
+    static void setLutUniforms(const ofShader & shader, const ColorLutPtr & lut);
+
+    // 3D lut, applied after gain, brightness and contrast
+    bool loadLut(string filePath);
+    void setLut(ColorLutPtr lut);
+    ColorLutPtr getLut() const;
+    void clearLut();
 
     ofParameter<float> brightness = { "Brightness", 0, -100, 100 };
     ofParameter<float> contrast = { "Contrast", 0, -100, 100 };
@@ -16,4 +25,7 @@ public:
     ofParameter<float> gainGreen = { "Green", 0, -100, 100 };
     ofParameter<float> gainBlue = { "Blue", 0, -100, 100 };
     ofParameterGroup group = { "Color correction", brightness, contrast, gainRed, gainGreen, gainBlue };
+
+private:
+    ColorLutPtr lut;
 };
@@ -0,0 +1,285 @@
+#include "ColorLut.h"
+#include "Profiler.h"
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define COLORLUT_SSE2
+#endif
+
+#define STR(a) #a
+
+static string colorLutFrag =
+STR(
+    uniform sampler3D colorLut;
+    uniform float colorLutEnabled;
+    uniform float colorLutSize;
+    uniform vec3 colorLutDomainMin;
+    uniform vec3 colorLutDomainScale;
+
+    vec4 colorLookup(vec4 color) {
+        if (colorLutEnabled > 0.5) {
+            vec3 c = clamp((color.rgb - colorLutDomainMin) * colorLutDomainScale, 0.0, 1.0);
+            c = c * ((colorLutSize - 1.0) / colorLutSize) + 0.5 / colorLutSize;
+            color.rgb = texture3D(colorLut, c).rgb;
+        }
+        return color;
+    }
+    );
+
+//--------------------------------------------------------------
+ColorLut::ColorLut() {
+	domainScale = glm::vec3(1);
+}
+
+//--------------------------------------------------------------
+ColorLut::~ColorLut() {
+	if (textureId != 0)
+		glDeleteTextures(1, &textureId);
+}
+
+//--------------------------------------------------------------
+bool ColorLut::load(string path) {
+
+	ofBuffer buffer = ofBufferFromFile(path);
+	if (buffer.size() == 0) {
+		ofLogError("ColorLut") << "Unable to load file: " << path;
+		return false;
+	}
+
+	const char * p = buffer.getData();
+	const char * end = p + buffer.size();
+
+	size_t lutSize = 0;
+	string lutTitle;
+	glm::vec3 dmin(0), dmax(1);
+	vector<glm::vec3> values;
+
+	while (p < end) {
+		const char * eol = (const char*)memchr(p, '\n', end - p);
+		if (!eol)
+			eol = end;
+		string line(p, eol);
+		p = eol + 1;
+
+		size_t first = line.find_first_not_of(" \t\r");
+		if (first == string::npos || line[first] == '#')
+			continue;
+
+		const char * s = line.c_str() + first;
+		if ((*s >= '0' && *s <= '9') || *s == '-' || *s == '+' || *s == '.') {
+			char * next;
+			glm::vec3 v;
+			v.x = strtof(s, &next);
+			v.y = strtof(next, &next);
+			v.z = strtof(next, &next);
+			values.push_back(v);
+		}
+		else if (line.compare(first, 11, "LUT_3D_SIZE") == 0) {
+			lutSize = strtoul(s + 11, NULL, 10);
+			values.reserve(lutSize * lutSize * lutSize);
+		}
+		else if (line.compare(first, 11, "LUT_1D_SIZE") == 0) {
+			ofLogError("ColorLut") << "1D LUTs are not supported: " << path;
+			return false;
+		}
+		else if (line.compare(first, 10, "DOMAIN_MIN") == 0) {
+			char * next;
+			dmin.x = strtof(s + 10, &next);
+			dmin.y = strtof(next, &next);
+			dmin.z = strtof(next, &next);
+		}
+		else if (line.compare(first, 10, "DOMAIN_MAX") == 0) {
+			char * next;
+			dmax.x = strtof(s + 10, &next);
+			dmax.y = strtof(next, &next);
+			dmax.z = strtof(next, &next);
+		}
+		else if (line.compare(first, 5, "TITLE") == 0) {
+			size_t q1 = line.find('"');
+			size_t q2 = line.rfind('"');
+			if (q1 != string::npos && q2 > q1)
+				lutTitle = line.substr(q1 + 1, q2 - q1 - 1);
+		}
+	}
+
+	if (lutSize < 2 || lutSize > 256 || values.size() != lutSize * lutSize * lutSize) {
+		ofLogError("ColorLut") << "Invalid 3D LUT: " << path;
+		return false;
+	}
+
+	set(lutSize, values, dmin, dmax);
+	title = lutTitle;
+	filePath = path;
+	return true;
+}
+
+//--------------------------------------------------------------
+void ColorLut::set(size_t lutSize, const vector<glm::vec3> & values, const glm::vec3 & dmin, const glm::vec3 & dmax) {
+	size = lutSize;
+	table.resize(values.size());
+	for (size_t i = 0; i < values.size(); i++) {
+		table[i] = glm::vec4(values[i], 0);
+	}
+	domainMin = dmin;
+	domainScale = glm::vec3(1.f / (dmax.x - dmin.x), 1.f / (dmax.y - dmin.y), 1.f / (dmax.z - dmin.z));
+	title.clear();
+	filePath.clear();
+	textureDirty = true;
+}
+
+//--------------------------------------------------------------
+bool ColorLut::isLoaded() const {
+	return size > 0;
+}
+
+//--------------------------------------------------------------
+size_t ColorLut::getSize() const {
+	return size;
+}
+
+//--------------------------------------------------------------
+string ColorLut::getTitle() const {
+	return title;
+}
+
+//--------------------------------------------------------------
+string ColorLut::getFilePath() const {
+	return filePath;
+}
+
+//--------------------------------------------------------------
+glm::vec3 ColorLut::apply(const glm::vec3 & color) const {
+	float out[4];
+	sample(&color.x, out);
+	return glm::vec3(out[0], out[1], out[2]);
+}
+
+//--------------------------------------------------------------
+void ColorLut::apply(float * pixels, size_t numPixels, size_t numChannels) const {
+	if (!isLoaded() || numChannels < 3)
+		return;
+	float out[4];
+	for (size_t i = 0; i < numPixels; i++) {
+		sample(pixels, out);
+		pixels[0] = out[0];
+		pixels[1] = out[1];
+		pixels[2] = out[2];
+		pixels += numChannels;
+	}
+}
+
+//--------------------------------------------------------------
+void ColorLut::apply(ofFloatPixels & pixels) const {
+	apply(pixels.getData(), pixels.getWidth() * pixels.getHeight(), pixels.getNumChannels());
+}
+
+//--------------------------------------------------------------
+void ColorLut::sample(const float * rgb, float * out) const {
+
+	// Lattice cell and weights per channel
+	size_t i0[3];
+	float w[3];
+	float last = size - 1;
+	for (int c = 0; c < 3; c++) {
+		float x = ofClamp((rgb[c] - domainMin[c]) * domainScale[c], 0.f, 1.f) * last;
+		size_t i = (size_t)x;
+		if (i > size - 2)
+			i = size - 2;
+		i0[c] = i;
+		w[c] = x - i;
+	}
+
+	size_t dg = size;
+	size_t db = size * size;
+	const float * c000 = &table[i0[2] * db + i0[1] * dg + i0[0]].x;
+	const float * c010 = c000 + dg * 4;
+	const float * c001 = c000 + db * 4;
+	const float * c011 = c001 + dg * 4;
+
+#ifdef COLORLUT_SSE2
+	// All three channels of a lattice point are interpolated in one register
+	__m128 wr = _mm_set1_ps(w[0]);
+	__m128 wg = _mm_set1_ps(w[1]);
+	__m128 wb = _mm_set1_ps(w[2]);
+
+	__m128 a = _mm_loadu_ps(c000);
+	__m128 b = _mm_loadu_ps(c010);
+	__m128 c = _mm_loadu_ps(c001);
+	__m128 d = _mm_loadu_ps(c011);
+	a = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(c000 + 4), a), wr));
+	b = _mm_add_ps(b, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(c010 + 4), b), wr));
+	c = _mm_add_ps(c, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(c001 + 4), c), wr));
+	d = _mm_add_ps(d, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(c011 + 4), d), wr));
+	a = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), wg));
+	c = _mm_add_ps(c, _mm_mul_ps(_mm_sub_ps(d, c), wg));
+	a = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(c, a), wb));
+	_mm_storeu_ps(out, a);
+#else
+	for (int ch = 0; ch < 3; ch++) {
+		float a = c000[ch] + (c000[ch + 4] - c000[ch]) * w[0];
+		float b = c010[ch] + (c010[ch + 4] - c010[ch]) * w[0];
+		float c = c001[ch] + (c001[ch + 4] - c001[ch]) * w[0];
+		float d = c011[ch] + (c011[ch + 4] - c011[ch]) * w[0];
+		a = a + (b - a) * w[1];
+		c = c + (d - c) * w[1];
+		out[ch] = a + (c - a) * w[2];
+	}
+	out[3] = 0;
+#endif
+}
+
+//--------------------------------------------------------------
+string ColorLut::getShaderSource() {
+	return colorLutFrag;
+}
+
+//--------------------------------------------------------------
+void ColorLut::setUniforms(const ofShader & shader, int textureLocation) {
+	if (!isLoaded()) {
+		setUniformsZero(shader, textureLocation);
+		return;
+	}
+	shader.setUniformTexture("colorLut", GL_TEXTURE_3D, getTextureId(), textureLocation);
+	shader.setUniform1f("colorLutEnabled", 1);
+	shader.setUniform1f("colorLutSize", size);
+	shader.setUniform3f("colorLutDomainMin", domainMin.x, domainMin.y, domainMin.z);
+	shader.setUniform3f("colorLutDomainScale", domainScale.x, domainScale.y, domainScale.z);
+	ofxMapper::Profiler::count(ofxMapper::COUNTER_UNIFORMS, 5);
+}
+
+//--------------------------------------------------------------
+void ColorLut::setUniformsZero(const ofShader & shader, int textureLocation) {
+	shader.setUniform1i("colorLut", textureLocation);
+	shader.setUniform1f("colorLutEnabled", 0);
+	ofxMapper::Profiler::count(ofxMapper::COUNTER_UNIFORMS, 2);
+}
+
+//--------------------------------------------------------------
+GLuint ColorLut::getTextureId() {
+	if (textureDirty && isLoaded()) {
+		if (textureId == 0)
+			glGenTextures(1, &textureId);
+
+		glBindTexture(GL_TEXTURE_3D, textureId);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+		glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA32F, size, size, size, 0, GL_RGBA, GL_FLOAT, table.data());
+		ofxMapper::Profiler::count(ofxMapper::COUNTER_ALLOCATIONS);
+		glBindTexture(GL_TEXTURE_3D, 0);
+
+		textureDirty = false;
+	}
+	return textureId;
+}
+
+//--------------------------------------------------------------
+void ColorLut::getMemoryUsage(ofxMapper::MemoryUsage & usage) const {
+	usage.cpu[ofxMapper::MEMORY_TEXTURES] += table.capacity() * sizeof(glm::vec4);
+	if (textureId)
+		usage.gpu[ofxMapper::MEMORY_TEXTURES] += size * size * size * sizeof(glm::vec4);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ofMain.h"
+#include "MemoryUsage.h"
+
+// 3D colour lookup table loaded from an Adobe/Resolve .cube file.
+// Sampled with trilinear interpolation, either by the GPU (3D texture) or on the CPU.
+class ColorLut {
+public:
+	ColorLut();
+	~ColorLut();
+
+	bool load(string filePath);
+	void set(size_t size, const vector<glm::vec3> & table, const glm::vec3 & domainMin = glm::vec3(0), const glm::vec3 & domainMax = glm::vec3(1));
+
+	bool isLoaded() const;
+	size_t getSize() const;
+	string getTitle() const;
+	string getFilePath() const;
+
+	// CPU transform
+	glm::vec3 apply(const glm::vec3 & color) const;
+	void apply(float * pixels, size_t numPixels, size_t numChannels = 3) const;
+	void apply(ofFloatPixels & pixels) const;
+
+	// GPU transform
+	static string getShaderSource();
+	void setUniforms(const ofShader & shader, int textureLocation = 2);
+	// The sampler still gets its own unit, so it never shares one with the 2D samplers
+	static void setUniformsZero(const ofShader & shader, int textureLocation = 2);
+	GLuint getTextureId();
+
+	// Add the table and the 3D texture once uploaded
+	void getMemoryUsage(ofxMapper::MemoryUsage & usage) const;
+
+private:
+	void sample(const float * rgb, float * out) const;
+
+	size_t size = 0;
+	string title;
+	string filePath;
+
+	glm::vec3 domainMin;
+	glm::vec3 domainScale;
+
+	// RGB padded to 4 floats per entry, red changing fastest
+	vector<glm::vec4> table;
+
+	GLuint textureId = 0;
+	bool textureDirty = false;
+};
+
+typedef shared_ptr<ColorLut> ColorLutPtr;
@@ -0,0 +1,368 @@
+#include "CompositionCache.h"
+#include "Tracer.h"
+
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace ofxMapper;
+
+static const char magic[4] = { 'O', 'F', 'X', 'M' };
+
+//--------------------------------------------------------------
+static void addString(std::string & strings, const std::string & s, CompositionCache::StringRef & ref) {
+	ref.offset = strings.size();
+	ref.size = s.size();
+	strings += s;
+}
+
+//--------------------------------------------------------------
+template<typename T>
+static void append(std::string & buffer, const T * items, size_t n) {
+	buffer.append((const char *)items, n * sizeof(T));
+}
+
+//--------------------------------------------------------------
+static void align(std::string & buffer) {
+	buffer.resize((buffer.size() + 7) & ~size_t(7));
+}
+
+//--------------------------------------------------------------
+CompositionCache::CompositionCache() : data(NULL), size(0) {
+#ifdef _WIN32
+	file = INVALID_HANDLE_VALUE;
+	mapping = NULL;
+#endif
+}
+
+//--------------------------------------------------------------
+CompositionCache::~CompositionCache() {
+	close();
+}
+
+//--------------------------------------------------------------
+uint64_t CompositionCache::hash(const std::string & text) {
+	uint64_t h = 14695981039346656037ull;
+	for (unsigned char c : text) {
+		h ^= c;
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+//--------------------------------------------------------------
+bool CompositionCache::write(const std::string & filePath, uint64_t sourceHash, const Rect & compositionSize, const std::vector<ScreenData> & screens) {
+	TraceScope trace("CompositionCache::write", "io");
+	std::vector<ScreenRecord> screenRecords;
+	std::vector<SliceRecord> sliceRecords;
+	std::vector<MaskRecord> maskRecords;
+	std::vector<glm::vec2> points;
+	std::string strings;
+
+	for (auto & screen : screens) {
+		ScreenRecord sr;
+		memset(&sr, 0, sizeof(sr));
+		sr.uniqueId = screen.uniqueId.value;
+		addString(strings, screen.name, sr.name);
+		sr.width = screen.width;
+		sr.height = screen.height;
+		sr.enabled = screen.enabled;
+		sr.firstSlice = sliceRecords.size();
+		sr.numSlices = screen.slices.size();
+		sr.firstMask = maskRecords.size();
+		sr.numMasks = screen.masks.size();
+		screenRecords.push_back(sr);
+
+		for (auto & slice : screen.slices) {
+			SliceRecord r;
+			memset(&r, 0, sizeof(r));
+			r.uniqueId = slice.uniqueId.value;
+			addString(strings, slice.name, r.name);
+			r.inputRect[0] = slice.inputRect.x;
+			r.inputRect[1] = slice.inputRect.y;
+			r.inputRect[2] = slice.inputRect.width;
+			r.inputRect[3] = slice.inputRect.height;
+			r.softEdgePower = slice.softEdgePower;
+			r.softEdgeLuminance = slice.softEdgeLuminance;
+			r.softEdgeGamma = slice.softEdgeGamma;
+			r.controlWidth = slice.controlWidth;
+			r.controlHeight = slice.controlHeight;
+			r.firstPoint = points.size();
+			r.numPoints = slice.vertices.size();
+			r.enabled = slice.enabled;
+			r.bezierEnabled = slice.bezierEnabled;
+			r.softEdgeEnabled = slice.softEdgeEnabled;
+			points.insert(points.end(), slice.vertices.begin(), slice.vertices.end());
+			sliceRecords.push_back(r);
+		}
+
+		for (auto & mask : screen.masks) {
+			MaskRecord r;
+			memset(&r, 0, sizeof(r));
+			r.uniqueId = mask.uniqueId.value;
+			addString(strings, mask.name, r.name);
+			r.feather = mask.feather;
+			r.firstPoint = points.size();
+			r.numPoints = mask.points.size();
+			r.enabled = mask.enabled;
+			r.closed = mask.closed;
+			r.inverted = mask.inverted;
+			points.insert(points.end(), mask.points.begin(), mask.points.end());
+			maskRecords.push_back(r);
+		}
+	}
+
+	Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, magic, sizeof(magic));
+	header.version = version;
+	header.sourceHash = sourceHash;
+	header.compositionWidth = compositionSize.width;
+	header.compositionHeight = compositionSize.height;
+	header.numScreens = screenRecords.size();
+	header.numSlices = sliceRecords.size();
+	header.numMasks = maskRecords.size();
+	header.numPoints = points.size();
+
+	// Header, then each array 8 byte aligned, strings last
+	std::string buffer(sizeof(Header), 0);
+	align(buffer);
+	header.screensOffset = buffer.size();
+	append(buffer, screenRecords.data(), screenRecords.size());
+	align(buffer);
+	header.slicesOffset = buffer.size();
+	append(buffer, sliceRecords.data(), sliceRecords.size());
+	align(buffer);
+	header.masksOffset = buffer.size();
+	append(buffer, maskRecords.data(), maskRecords.size());
+	align(buffer);
+	header.pointsOffset = buffer.size();
+	append(buffer, points.data(), points.size());
+	header.stringsOffset = buffer.size();
+	header.stringsSize = strings.size();
+	buffer += strings;
+	header.size = buffer.size();
+	memcpy(&buffer[0], &header, sizeof(header));
+
+	// Write aside and rename, a reader never sees a partial file
+	std::string tmpPath = filePath + ".tmp";
+	{
+		std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+		if (!out.write(buffer.data(), buffer.size()))
+			return false;
+	}
+#ifdef _WIN32
+	if (!MoveFileExA(tmpPath.c_str(), filePath.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+#else
+	if (rename(tmpPath.c_str(), filePath.c_str()) != 0) {
+#endif
+		remove(tmpPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+bool CompositionCache::open(const std::string & filePath, uint64_t sourceHash) {
+	TraceScope trace("CompositionCache::open", "io");
+	close();
+
+#ifdef _WIN32
+	file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(Header)) {
+		close();
+		return false;
+	}
+	mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!mapping) {
+		close();
+		return false;
+	}
+	data = (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	size = fileSize.QuadPart;
+#else
+	int fd = ::open(filePath.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(Header)) {
+		::close(fd);
+		return false;
+	}
+	void * p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (p == MAP_FAILED)
+		return false;
+	data = (const char *)p;
+	size = st.st_size;
+#endif
+
+	if (!data || !validate(sourceHash)) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+bool CompositionCache::validate(uint64_t sourceHash) const {
+	const Header & h = *(const Header *)data;
+	if (memcmp(h.magic, magic, sizeof(magic)) != 0 || h.version != version || h.size != size || h.sourceHash != sourceHash)
+		return false;
+
+	auto inside = [&](uint64_t offset, uint64_t n, size_t itemSize) {
+		return offset <= size && n * itemSize <= size - offset;
+	};
+	if (!inside(h.screensOffset, h.numScreens, sizeof(ScreenRecord)) ||
+		!inside(h.slicesOffset, h.numSlices, sizeof(SliceRecord)) ||
+		!inside(h.masksOffset, h.numMasks, sizeof(MaskRecord)) ||
+		!inside(h.pointsOffset, h.numPoints, sizeof(glm::vec2)) ||
+		!inside(h.stringsOffset, h.stringsSize, 1))
+		return false;
+
+	auto validString = [&](const StringRef & s) {
+		return (uint64_t)s.offset + s.size <= h.stringsSize;
+	};
+	auto validPoints = [&](uint32_t first, uint32_t n) {
+		return (uint64_t)first + n <= h.numPoints;
+	};
+	for (size_t i = 0; i < h.numScreens; i++) {
+		const ScreenRecord & s = getScreen(i);
+		if (!validString(s.name) ||
+			(uint64_t)s.firstSlice + s.numSlices > h.numSlices ||
+			(uint64_t)s.firstMask + s.numMasks > h.numMasks)
+			return false;
+	}
+	for (size_t i = 0; i < h.numSlices; i++) {
+		const SliceRecord & s = getSlice(i);
+		if (!validString(s.name) || !validPoints(s.firstPoint, s.numPoints))
+			return false;
+	}
+	for (size_t i = 0; i < h.numMasks; i++) {
+		const MaskRecord & m = getMask(i);
+		if (!validString(m.name) || !validPoints(m.firstPoint, m.numPoints))
+			return false;
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+void CompositionCache::close() {
+#ifdef _WIN32
+	if (data)
+		UnmapViewOfFile(data);
+	if (mapping)
+		CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+	mapping = NULL;
+	file = INVALID_HANDLE_VALUE;
+#else
+	if (data)
+		munmap((void *)data, size);
+#endif
+	data = NULL;
+	size = 0;
+}
+
+//--------------------------------------------------------------
+bool CompositionCache::isOpen() const {
+	return data != NULL;
+}
+
+//--------------------------------------------------------------
+Rect CompositionCache::getCompositionSize() const {
+	const Header & h = *(const Header *)data;
+	return Rect(0, 0, h.compositionWidth, h.compositionHeight);
+}
+
+//--------------------------------------------------------------
+size_t CompositionCache::getNumScreens() const {
+	return ((const Header *)data)->numScreens;
+}
+
+//--------------------------------------------------------------
+const CompositionCache::ScreenRecord & CompositionCache::getScreen(size_t i) const {
+	return ((const ScreenRecord *)(data + ((const Header *)data)->screensOffset))[i];
+}
+
+//--------------------------------------------------------------
+const CompositionCache::SliceRecord & CompositionCache::getSlice(size_t i) const {
+	return ((const SliceRecord *)(data + ((const Header *)data)->slicesOffset))[i];
+}
+
+//--------------------------------------------------------------
+const CompositionCache::MaskRecord & CompositionCache::getMask(size_t i) const {
+	return ((const MaskRecord *)(data + ((const Header *)data)->masksOffset))[i];
+}
+
+//--------------------------------------------------------------
+const glm::vec2 * CompositionCache::getPoints(uint32_t first) const {
+	return (const glm::vec2 *)(data + ((const Header *)data)->pointsOffset) + first;
+}
+
+//--------------------------------------------------------------
+std::string CompositionCache::getString(const StringRef & ref) const {
+	return std::string(data + ((const Header *)data)->stringsOffset + ref.offset, ref.size);
+}
+
+//--------------------------------------------------------------
+void CompositionCache::read(std::vector<ScreenData> & screens) const {
+	screens.clear();
+	size_t n = getNumScreens();
+	screens.resize(n);
+	for (size_t i = 0; i < n; i++) {
+		const ScreenRecord & sr = getScreen(i);
+		ScreenData & screen = screens[i];
+		screen.uniqueId = UniqueId(sr.uniqueId);
+		screen.name = getString(sr.name);
+		screen.width = sr.width;
+		screen.height = sr.height;
+		screen.enabled = sr.enabled != 0;
+
+		screen.slices.resize(sr.numSlices);
+		for (size_t j = 0; j < sr.numSlices; j++) {
+			const SliceRecord & r = getSlice(sr.firstSlice + j);
+			SliceData & slice = screen.slices[j];
+			slice.uniqueId = UniqueId(r.uniqueId);
+			slice.name = getString(r.name);
+			slice.enabled = r.enabled != 0;
+			slice.inputRect.set(r.inputRect[0], r.inputRect[1], r.inputRect[2], r.inputRect[3]);
+			slice.bezierEnabled = r.bezierEnabled != 0;
+			slice.softEdgeEnabled = r.softEdgeEnabled != 0;
+			slice.softEdgePower = r.softEdgePower;
+			slice.softEdgeLuminance = r.softEdgeLuminance;
+			slice.softEdgeGamma = r.softEdgeGamma;
+			slice.controlWidth = r.controlWidth;
+			slice.controlHeight = r.controlHeight;
+			const glm::vec2 * p = getPoints(r.firstPoint);
+			slice.vertices.assign(p, p + r.numPoints);
+		}
+
+		screen.masks.resize(sr.numMasks);
+		for (size_t j = 0; j < sr.numMasks; j++) {
+			const MaskRecord & r = getMask(sr.firstMask + j);
+			MaskData & mask = screen.masks[j];
+			mask.uniqueId = UniqueId(r.uniqueId);
+			mask.name = getString(r.name);
+			mask.enabled = r.enabled != 0;
+			mask.closed = r.closed != 0;
+			mask.inverted = r.inverted != 0;
+			mask.feather = r.feather;
+			const glm::vec2 * p = getPoints(r.firstPoint);
+			mask.points.assign(p, p + r.numPoints);
+		}
+	}
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "MapperData.h"
+
+// Binary snapshot of a parsed composition, tagged with a hash of the source text.
+// The file is memory mapped and read in place, records and vertex arrays are
+// views into the mapping. Any mismatch in version, size or hash fails open(). Paths
+// are used as given, not resolved against the data folder.
+class CompositionCache {
+public:
+	static const uint32_t version = 2;
+
+	struct StringRef {
+		uint32_t offset;
+		uint32_t size;
+	};
+
+	struct ScreenRecord {
+		uint64_t uniqueId;
+		StringRef name;
+		int32_t width;
+		int32_t height;
+		uint32_t firstSlice;
+		uint32_t numSlices;
+		uint32_t firstMask;
+		uint32_t numMasks;
+		uint32_t enabled;
+	};
+
+	struct SliceRecord {
+		uint64_t uniqueId;
+		StringRef name;
+		float inputRect[4];
+		float softEdgePower;
+		float softEdgeLuminance;
+		float softEdgeGamma;
+		uint32_t controlWidth;
+		uint32_t controlHeight;
+		uint32_t firstPoint;
+		uint32_t numPoints;
+		uint8_t enabled;
+		uint8_t bezierEnabled;
+		uint8_t softEdgeEnabled;
+		uint8_t padding;
+	};
+
+	struct MaskRecord {
+		uint64_t uniqueId;
+		StringRef name;
+		float feather;
+		uint32_t firstPoint;
+		uint32_t numPoints;
+		uint8_t enabled;
+		uint8_t closed;
+		uint8_t inverted;
+		uint8_t padding;
+	};
+
+	CompositionCache();
+	~CompositionCache();
+
+	// 64 bit FNV-1a of the source text
+	static uint64_t hash(const std::string & text);
+
+	static bool write(const std::string & filePath, uint64_t sourceHash, const ofxMapper::Rect & compositionSize, const std::vector<ofxMapper::ScreenData> & screens);
+
+	// Map the file and check it was written from source text with this hash
+	bool open(const std::string & filePath, uint64_t sourceHash);
+	void close();
+	bool isOpen() const;
+
+	// Views into the mapping, valid until close()
+	ofxMapper::Rect getCompositionSize() const;
+	size_t getNumScreens() const;
+	const ScreenRecord & getScreen(size_t i) const;
+	const SliceRecord & getSlice(size_t i) const;
+	const MaskRecord & getMask(size_t i) const;
+	const glm::vec2 * getPoints(uint32_t first) const;
+	std::string getString(const StringRef & ref) const;
+
+	// Copy everything out into screen data
+	void read(std::vector<ofxMapper::ScreenData> & screens) const;
+
+private:
+	struct Header {
+		char magic[4];
+		uint32_t version;
+		uint64_t sourceHash;
+		uint64_t size;
+		float compositionWidth;
+		float compositionHeight;
+		uint32_t numScreens;
+		uint32_t numSlices;
+		uint32_t numMasks;
+		uint32_t numPoints;
+		uint32_t screensOffset;
+		uint32_t slicesOffset;
+		uint32_t masksOffset;
+		uint32_t pointsOffset;
+		uint32_t stringsOffset;
+		uint32_t stringsSize;
+	};
+
+	bool validate(uint64_t sourceHash) const;
+
+	const char * data;
+	size_t size;
+#ifdef _WIN32
+	void * file;
+	void * mapping;
+#endif
+};
@@ -0,0 +1,239 @@
+#include "CompositionLoader.h"
+#include "ResolumeParser.h"
+#include "CompositionCache.h"
+#include "Tracer.h"
+
+using namespace ofxMapper;
+
+// Share of the progress taken by reading, the rest is split between construction and geometry
+static const float readProgress = 0.2f;
+static const float constructProgress = 0.2f;
+
+//--------------------------------------------------------------
+CompositionLoader::~CompositionLoader() {
+	cancel();
+}
+
+//--------------------------------------------------------------
+bool CompositionLoader::read(const string & filePath, bool useCache) {
+	TraceScope trace("CompositionLoader::read", "load");
+
+	uint64_t startTime = ofGetElapsedTimeMicros();
+
+	this->filePath = filePath;
+	stats = LoadStats();
+
+	if (!ofFile::doesFileExist(filePath)) {
+		ofLogError("ofxMapper") << "Unable to load file: " << filePath;
+		return false;
+	}
+	source = ofBufferFromFile(filePath).getText();
+
+	// Use the snapshot while it matches the XML, otherwise read straight into screen data
+	// in one pass. The DOM is only built if the file is saved.
+	sourceHash = CompositionCache::hash(source);
+	string cachePath = ofToDataPath(filePath) + ".cache";
+	if (useCache) {
+		CompositionCache cache;
+		if (cache.open(cachePath, sourceHash)) {
+			compositionSize = cache.getCompositionSize();
+			cache.read(data);
+			stats.cached = true;
+		}
+	}
+
+	if (!stats.cached) {
+		ResolumeParser parser;
+		if (!parser.parse(source)) {
+			ofLogError("ofxMapper") << "Unable to load file: " << filePath;
+			return false;
+		}
+
+		if (!parser.isValid("Resolume Arena") && !parser.isValid("ofxMapper")) {
+			ofLogError("ofxMapper") << "File not valid: " << filePath;
+			return false;
+		}
+
+		compositionSize = parser.getCompositionSize();
+		data = std::move(parser.getScreens());
+		if (useCache && !CompositionCache::write(cachePath, sourceHash, compositionSize, data))
+			ofLogError("ofxMapper") << "Unable to write cache: " << cachePath;
+	}
+
+	stats.parse = (ofGetElapsedTimeMicros() - startTime) / 1000000.f;
+	progress = readProgress;
+	return true;
+}
+
+//--------------------------------------------------------------
+bool CompositionLoader::build(const vector<ScreenData> & data) {
+	TraceScope trace("CompositionLoader::build", "load");
+
+	uint64_t startTime = ofGetElapsedTimeMicros();
+	float startProgress = progress;
+
+	screens.clear();
+	screens.reserve(data.size());
+	stats.numScreens = 0;
+	stats.numSlices = 0;
+	stats.numMasks = 0;
+
+	// Screens are placed side by side, like Mapper::addScreen
+	int x = 0;
+	int y = 0;
+	for (size_t i = 0; i < data.size(); i++) {
+		if (cancelled)
+			return false;
+
+		auto & sd = data[i];
+		ScreenPtr screen(new Screen(x, y, sd.width, sd.height, false));
+		ofRectangle rect = screen->getScreenRect();
+		x = rect.getRight();
+		y = rect.getTop();
+
+		screen->name = sd.name;
+		if (sd.uniqueId.isValid())
+			screen->uniqueId = sd.uniqueId;
+		screen->enabled = sd.enabled;
+
+		for (auto & slice : sd.slices) {
+			screen->addSlice(slice);
+		}
+		for (auto & mask : sd.masks) {
+			screen->addMask(mask);
+		}
+		screens.push_back(screen);
+
+		stats.numSlices += sd.slices.size();
+		stats.numMasks += sd.masks.size();
+		progress = startProgress + constructProgress * (i + 1) / data.size();
+	}
+	stats.numScreens = screens.size();
+
+	uint64_t constructTime = ofGetElapsedTimeMicros();
+	startProgress = progress;
+
+	// Build all geometry once, slices and masks are independent
+	vector<SlicePtr> slices;
+	vector<MaskPtr> masks;
+	for (auto & screen : screens) {
+		slices.insert(slices.end(), screen->getSlices().begin(), screen->getSlices().end());
+		masks.insert(masks.end(), screen->getMasks().begin(), screen->getMasks().end());
+	}
+
+	size_t n = slices.size() + masks.size();
+	size_t threads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), n);
+	std::atomic<size_t> next(0);
+	std::atomic<size_t> done(0);
+	auto work = [&]() {
+		for (size_t i = next++; i < n && !cancelled; i = next++) {
+			if (i < slices.size())
+				slices[i]->flush();
+			else
+				masks[i - slices.size()]->flush();
+			progress = startProgress + (1 - startProgress) * ++done / n;
+		}
+	};
+	if (threads > 1) {
+		vector<std::thread> workers;
+		for (size_t i = 0; i < threads; i++) {
+			workers.emplace_back([&]() {
+				Tracer::setThreadName("geometry");
+				work();
+			});
+		}
+		for (auto & t : workers) {
+			t.join();
+		}
+	}
+	else {
+		work();
+	}
+
+	uint64_t buildTime = ofGetElapsedTimeMicros();
+
+	stats.construct = (constructTime - startTime) / 1000000.f;
+	stats.build = (buildTime - constructTime) / 1000000.f;
+	progress = 1;
+
+	return !cancelled;
+}
+
+//--------------------------------------------------------------
+void CompositionLoader::start(const string & filePath, bool useCache, bool buildScreens) {
+	cancel();
+	this->filePath = filePath;
+	this->useCache = useCache;
+	this->buildScreens = buildScreens;
+	cancelled = false;
+	progress = 0;
+	state = LOAD_RUNNING;
+	thread = std::thread(&CompositionLoader::threadedFunction, this);
+}
+
+//--------------------------------------------------------------
+void CompositionLoader::cancel() {
+	cancelled = true;
+	if (thread.joinable())
+		thread.join();
+}
+
+//--------------------------------------------------------------
+CompositionLoader::State CompositionLoader::getState() const {
+	return (State)state.load();
+}
+
+//--------------------------------------------------------------
+float CompositionLoader::getProgress() const {
+	return progress;
+}
+
+//--------------------------------------------------------------
+const string & CompositionLoader::getFilePath() const {
+	return filePath;
+}
+
+//--------------------------------------------------------------
+ofRectangle CompositionLoader::getCompositionSize() const {
+	return compositionSize;
+}
+
+//--------------------------------------------------------------
+vector<ScreenData> & CompositionLoader::getData() {
+	return data;
+}
+
+//--------------------------------------------------------------
+vector<ScreenPtr> & CompositionLoader::getScreens() {
+	return screens;
+}
+
+//--------------------------------------------------------------
+string & CompositionLoader::getSource() {
+	return source;
+}
+
+//--------------------------------------------------------------
+uint64_t CompositionLoader::getSourceHash() const {
+	return sourceHash;
+}
+
+//--------------------------------------------------------------
+const LoadStats & CompositionLoader::getStats() const {
+	return stats;
+}
+
+//--------------------------------------------------------------
+void CompositionLoader::threadedFunction() {
+	Tracer::setThreadName("loader");
+	if (!read(filePath, useCache)) {
+		state = cancelled ? LOAD_CANCELLED : LOAD_FAILED;
+		return;
+	}
+	if (buildScreens && !build(data)) {
+		state = LOAD_CANCELLED;
+		return;
+	}
+	// Results are published by this store, the render thread reads them after seeing it
+	state = LOAD_READY;
+}
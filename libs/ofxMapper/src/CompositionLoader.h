@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Screen.h"
+#include "MapperData.h"
+#include <thread>
+#include <atomic>
+
+namespace ofxMapper {
+
+	// Reads a composition and builds its screens, slices and masks without any GL calls,
+	// on the calling thread or on a worker. Screens come out with their frame buffers
+	// unallocated, the mapper allocates them on the render thread before swapping them in.
+	class CompositionLoader {
+	public:
+		enum State {
+			LOAD_IDLE, LOAD_RUNNING, LOAD_READY, LOAD_FAILED, LOAD_CANCELLED
+		};
+
+		~CompositionLoader();
+
+		// Read screen data from the file, or from its cache while the file is unchanged
+		bool read(const string & filePath, bool useCache);
+		// Construct screens from data and build their geometry, in parallel across slices and masks
+		bool build(const vector<ScreenData> & data);
+
+		// read() and build() on a worker thread, or only read() to merge the data yourself
+		void start(const string & filePath, bool useCache, bool buildScreens = true);
+		// Stop the worker at the next screen, slice or mask and wait for it
+		void cancel();
+		State getState() const;
+		// From 0 to 1 over reading and building
+		float getProgress() const;
+
+		// Results, only valid once read() or build() returned or the state is LOAD_READY
+		const string & getFilePath() const;
+		ofRectangle getCompositionSize() const;
+		vector<ScreenData> & getData();
+		vector<ScreenPtr> & getScreens();
+		string & getSource();
+		// CompositionCache::hash of the source text
+		uint64_t getSourceHash() const;
+		const LoadStats & getStats() const;
+
+	private:
+		void threadedFunction();
+
+		std::thread thread;
+		std::atomic<int> state{ LOAD_IDLE };
+		std::atomic<float> progress{ 0 };
+		std::atomic<bool> cancelled{ false };
+
+		string filePath;
+		bool useCache = false;
+		bool buildScreens = true;
+		ofRectangle compositionSize;
+		vector<ScreenData> data;
+		vector<ScreenPtr> screens;
+		string source;
+		uint64_t sourceHash = 0;
+		LoadStats stats;
+	};
+
+	typedef shared_ptr<CompositionLoader> CompositionLoaderPtr;
+}
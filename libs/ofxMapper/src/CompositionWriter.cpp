@@ -0,0 +1,233 @@
+#include "CompositionWriter.h"
+#include "Tracer.h"
+#include "CompositionCache.h"
+#include <unordered_set>
+#include <algorithm>
+
+using namespace ofxMapper;
+
+//--------------------------------------------------------------
+CompositionWriter::CompositionWriter() {
+}
+
+//--------------------------------------------------------------
+CompositionWriter::~CompositionWriter() {
+	wait();
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		running = false;
+	}
+	condition.notify_all();
+	if (thread.joinable())
+		thread.join();
+}
+
+//--------------------------------------------------------------
+bool CompositionWriter::reset(shared_ptr<ResolumeFile> file, const vector<ScreenData> & saved) {
+	std::unique_lock<std::mutex> lock(mutex);
+	bool dropped = pending != nullptr;
+	pending.reset();
+	nextFile = file;
+	nextSaved = saved;
+	resetPending = true;
+	if (!busy) {
+		applyReset();
+		idle.notify_all();
+	}
+	return dropped;
+}
+
+//--------------------------------------------------------------
+void CompositionWriter::applyReset() {
+	file = std::move(nextFile);
+	saved = std::move(nextSaved);
+	nextFile.reset();
+	nextSaved.clear();
+	resetPending = false;
+	numWritten = 0;
+	lastResult = true;
+}
+
+//--------------------------------------------------------------
+void CompositionWriter::save(const string & filePath, const ofRectangle & compRect, vector<ScreenData> && screens) {
+	std::unique_lock<std::mutex> lock(mutex);
+	if (!file && !resetPending) {
+		ofLogError("ofxMapper") << "No document to save: " << filePath;
+		return;
+	}
+	pending.reset(new Job);
+	pending->filePath = filePath;
+	pending->compRect = compRect;
+	pending->screens = std::move(screens);
+
+	if (!running) {
+		running = true;
+		thread = std::thread(&CompositionWriter::threadedFunction, this);
+	}
+	condition.notify_one();
+}
+
+//--------------------------------------------------------------
+void CompositionWriter::wait() {
+	std::unique_lock<std::mutex> lock(mutex);
+	idle.wait(lock, [this]() { return !busy && !pending; });
+}
+
+//--------------------------------------------------------------
+bool CompositionWriter::isBusy() {
+	std::unique_lock<std::mutex> lock(mutex);
+	return busy || pending;
+}
+
+//--------------------------------------------------------------
+size_t CompositionWriter::getNumWritten() {
+	std::unique_lock<std::mutex> lock(mutex);
+	return numWritten;
+}
+
+//--------------------------------------------------------------
+bool CompositionWriter::getLastResult() {
+	std::unique_lock<std::mutex> lock(mutex);
+	return lastResult;
+}
+
+//--------------------------------------------------------------
+bool CompositionWriter::wasWritten(uint64_t sourceHash) {
+	std::unique_lock<std::mutex> lock(mutex);
+	return std::find(writtenHashes.begin(), writtenHashes.end(), sourceHash) != writtenHashes.end();
+}
+
+//--------------------------------------------------------------
+void CompositionWriter::threadedFunction() {
+	Tracer::setThreadName("writer");
+	std::unique_lock<std::mutex> lock(mutex);
+	while (running) {
+		condition.wait(lock, [this]() { return pending || !running; });
+		if (!pending)
+			continue;
+
+		unique_ptr<Job> job = std::move(pending);
+		busy = true;
+		lock.unlock();
+
+		size_t written = 0;
+		uint64_t writtenHash = 0;
+		bool result = write(*job, written, writtenHash);
+
+		lock.lock();
+		busy = false;
+		numWritten = written;
+		lastResult = result;
+		if (result) {
+			writtenHashes.push_back(writtenHash);
+			if (writtenHashes.size() > 8)
+				writtenHashes.pop_front();
+		}
+		if (resetPending)
+			applyReset();
+		if (!pending)
+			idle.notify_all();
+	}
+}
+
+//--------------------------------------------------------------
+bool CompositionWriter::write(Job & job, size_t & written, uint64_t & writtenHash) {
+	TraceScope trace("CompositionWriter::write", "io");
+	file->setCompositionSize(job.compRect.width, job.compRect.height);
+
+	unordered_map<UniqueId, ScreenData *> previous;
+	for (auto & screen : saved) {
+		previous[screen.uniqueId] = &screen;
+	}
+	unordered_set<UniqueId> current;
+	for (auto & screen : job.screens) {
+		current.insert(screen.uniqueId);
+	}
+
+	// Remove deleted screens
+	for (auto & screen : saved) {
+		if (!current.count(screen.uniqueId))
+			file->removeScreen(screen.uniqueId);
+	}
+	file->loadScreens();
+
+	for (auto & screen : job.screens) {
+		auto it = previous.find(screen.uniqueId);
+		ScreenData * prev = it == previous.end() ? NULL : it->second;
+
+		unordered_map<UniqueId, const SliceData *> prevSlices;
+		unordered_map<UniqueId, const MaskData *> prevMasks;
+		if (prev) {
+			for (auto & slice : prev->slices)
+				prevSlices[slice.uniqueId] = &slice;
+			for (auto & mask : prev->masks)
+				prevMasks[mask.uniqueId] = &mask;
+		}
+
+		// Find what changed before touching the document
+		bool screenChanged = !prev || !isScreenEqual(*prev, screen);
+		vector<SliceData *> changedSlices;
+		vector<MaskData *> changedMasks;
+		for (auto & slice : screen.slices) {
+			auto s = prevSlices.find(slice.uniqueId);
+			if (s == prevSlices.end() || !(*s->second == slice))
+				changedSlices.push_back(&slice);
+			if (s != prevSlices.end())
+				prevSlices.erase(s);
+		}
+		for (auto & mask : screen.masks) {
+			auto m = prevMasks.find(mask.uniqueId);
+			if (m == prevMasks.end() || !(*m->second == mask))
+				changedMasks.push_back(&mask);
+			if (m != prevMasks.end())
+				prevMasks.erase(m);
+		}
+		// Whatever is left was deleted
+		if (!screenChanged && changedSlices.empty() && changedMasks.empty() && prevSlices.empty() && prevMasks.empty())
+			continue;
+
+		ResolumeFile::Screen scr = file->getScreen(screen.uniqueId);
+		if (screenChanged) {
+			scr.setName(screen.name);
+			scr.setEnabled(screen.enabled);
+			scr.setSize(screen.width, screen.height);
+			written++;
+		}
+
+		for (auto & slice : prevSlices) {
+			scr.removeSlice(slice.first);
+		}
+		for (SliceData * slice : changedSlices) {
+			ResolumeFile::Slice slc = scr.getSlice(slice->uniqueId);
+			slc.setName(slice->name);
+			slc.setEnabled(slice->enabled);
+			slc.setInputRect(slice->inputRect);
+			slc.setWarperMode(slice->bezierEnabled ? "PM_BEZIER" : "PM_LINEAR");
+			slc.setWarperVertices(slice->controlWidth, slice->controlHeight, slice->vertices.data());
+			written++;
+		}
+
+		for (auto & mask : prevMasks) {
+			scr.removeMask(mask.first);
+		}
+		for (MaskData * mask : changedMasks) {
+			ResolumeFile::Mask msk = scr.getMask(mask->uniqueId);
+			msk.setName(mask->name);
+			msk.setEnabled(mask->enabled);
+			msk.setInverted(mask->inverted);
+			msk.setFeather(mask->feather);
+			msk.setPoints(mask->points, mask->closed);
+			written++;
+		}
+	}
+
+	saved = std::move(job.screens);
+
+	string text;
+	if (!file->save(job.filePath, &text)) {
+		ofLogError("ofxMapper") << "Unable to save file: " << job.filePath;
+		return false;
+	}
+	writtenHash = CompositionCache::hash(text);
+	return true;
+}
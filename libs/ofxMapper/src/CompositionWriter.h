@@ -0,0 +1,69 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ResolumeFile.h"
+#include "MapperData.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+namespace ofxMapper {
+
+	// Saves snapshots of the model on a background thread. Each snapshot is compared with
+	// the last one written and only changed screens, slices and masks are rewritten in the
+	// document, which is then written aside and renamed over the target file.
+	class CompositionWriter {
+	public:
+		CompositionWriter();
+		~CompositionWriter();
+
+		// Start over from a document, with saved describing what it already holds. Doesn't
+		// wait for a save in progress, the writer switches documents once it is done. A
+		// snapshot still waiting belongs to the old document and is dropped, returns true if so.
+		bool reset(shared_ptr<ResolumeFile> file, const vector<ScreenData> & saved);
+
+		// Queue a snapshot and return. A snapshot still waiting is replaced by a newer one.
+		void save(const string & filePath, const ofRectangle & compRect, vector<ScreenData> && screens);
+		// Block until queued snapshots are written
+		void wait();
+		bool isBusy();
+
+		// Nodes rewritten by the last save, and whether it succeeded
+		size_t getNumWritten();
+		bool getLastResult();
+		// Whether one of the last files written had this CompositionCache::hash, to tell
+		// our own saves from external edits
+		bool wasWritten(uint64_t sourceHash);
+
+	private:
+		struct Job {
+			string filePath;
+			ofRectangle compRect;
+			vector<ScreenData> screens;
+		};
+
+		void threadedFunction();
+		bool write(Job & job, size_t & written, uint64_t & writtenHash);
+		void applyReset();
+
+		std::thread thread;
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::condition_variable idle;
+		bool running = false;
+		bool busy = false;
+		unique_ptr<Job> pending;
+		// Document to switch to once the save in progress is done
+		shared_ptr<ResolumeFile> nextFile;
+		vector<ScreenData> nextSaved;
+		bool resetPending = false;
+		deque<uint64_t> writtenHashes;
+
+		// Only touched by the writer thread while busy
+		shared_ptr<ResolumeFile> file;
+		vector<ScreenData> saved;
+		size_t numWritten = 0;
+		bool lastResult = true;
+	};
+}
@@ -0,0 +1,261 @@
+#include "DistanceField.h"
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "Tracer.h"
+
+namespace {
+
+	// Threads kept for the life of the process. A job hands out bands of rows to the
+	// workers and the calling thread, jobs from several callers run one at a time.
+	class RowWorkers {
+	public:
+		static RowWorkers & get() {
+			static RowWorkers workers;
+			return workers;
+		}
+
+		size_t size() const {
+			return threads.size() + 1;
+		}
+
+		void run(size_t rows, size_t band, const std::function<void(size_t, size_t)> & fn) {
+			std::lock_guard<std::mutex> jobLock(jobMutex);
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				job = &fn;
+				numRows = rows;
+				bandSize = band;
+				next = 0;
+				started = 0;
+				generation++;
+			}
+			condition.notify_all();
+			work();
+
+			// Every worker takes each job once, wait for all of them so none is left
+			// holding this one when the next starts
+			std::unique_lock<std::mutex> lock(mutex);
+			finished.wait(lock, [this]() { return started == threads.size() && active == 0; });
+			job = NULL;
+		}
+
+	private:
+		RowWorkers() {
+			size_t n = std::max(1u, std::thread::hardware_concurrency()) - 1;
+			for (size_t i = 0; i < n; i++) {
+				threads.emplace_back(&RowWorkers::threadedFunction, this);
+			}
+		}
+
+		~RowWorkers() {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stopping = true;
+			}
+			condition.notify_all();
+			for (auto & t : threads) {
+				t.join();
+			}
+		}
+
+		void threadedFunction() {
+			Tracer::setThreadName("distance");
+			std::unique_lock<std::mutex> lock(mutex);
+			uint64_t seen = 0;
+			while (true) {
+				condition.wait(lock, [&]() { return stopping || generation != seen; });
+				if (stopping)
+					return;
+				seen = generation;
+				started++;
+				active++;
+				lock.unlock();
+				work();
+				lock.lock();
+				active--;
+				finished.notify_all();
+			}
+		}
+
+		void work() {
+			while (true) {
+				size_t y0;
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					if (next >= numRows)
+						return;
+					y0 = next;
+					next = std::min(numRows, next + bandSize);
+				}
+				(*job)(y0, std::min(numRows, y0 + bandSize));
+			}
+		}
+
+		std::vector<std::thread> threads;
+		std::mutex jobMutex;
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::condition_variable finished;
+		const std::function<void(size_t, size_t)> * job = NULL;
+		size_t numRows = 0;
+		size_t bandSize = 0;
+		size_t next = 0;
+		size_t started = 0;
+		size_t active = 0;
+		uint64_t generation = 0;
+		bool stopping = false;
+	};
+
+	// Where a row crosses the capsule of points within r of segment ab, which is convex,
+	// so the hull of the crossings of its end caps and sides is the whole span
+	bool getSpan(glm::vec2 a, glm::vec2 b, glm::vec2 offset, float r, float py, float & lo, float & hi) {
+		lo = FLT_MAX;
+		hi = -FLT_MAX;
+		for (glm::vec2 c : { a, b }) {
+			float dy = py - c.y;
+			float h2 = r * r - dy * dy;
+			if (h2 >= 0) {
+				float h = std::sqrt(h2);
+				lo = std::min(lo, c.x - h);
+				hi = std::max(hi, c.x + h);
+			}
+		}
+		for (glm::vec2 side : { offset, -offset }) {
+			glm::vec2 sa = a + side;
+			glm::vec2 sb = b + side;
+			if (sa.y != sb.y && (sa.y <= py) != (sb.y <= py)) {
+				float x = sa.x + (py - sa.y) * (sb.x - sa.x) / (sb.y - sa.y);
+				lo = std::min(lo, x);
+				hi = std::max(hi, x);
+			}
+		}
+		return lo <= hi;
+	}
+}
+
+//--------------------------------------------------------------
+void DistanceField::compute(const std::vector<std::vector<glm::vec2>> & contours, size_t w, size_t h, float maxDist) {
+	width = w;
+	height = h;
+	maxDistance = std::max(maxDist, 0.0001f);
+	distances.resize(width * height);
+
+	segments.clear();
+	for (auto & contour : contours) {
+		size_t n = contour.size();
+		if (n < 2)
+			continue;
+		for (size_t i = 0; i < n; i++) {
+			Segment s;
+			s.a = contour[i];
+			s.b = contour[(i + 1) % n];
+			s.minY = std::min(s.a.y, s.b.y) - maxDistance;
+			s.maxY = std::max(s.a.y, s.b.y) + maxDistance;
+			glm::vec2 ab = s.b - s.a;
+			float len = glm::length(ab);
+			s.offset = len > 0 ? glm::vec2(-ab.y, ab.x) * (maxDistance / len) : glm::vec2(0.f);
+			segments.push_back(s);
+		}
+	}
+
+	if (width == 0 || height == 0)
+		return;
+
+	// Bands of at least 64 rows, so small fields stay on the calling thread
+	RowWorkers & workers = RowWorkers::get();
+	size_t threads = std::min(workers.size(), std::max<size_t>(1, height / 64));
+	if (threads == 1) {
+		computeRows(0, height);
+		return;
+	}
+
+	size_t band = (height + threads - 1) / threads;
+	workers.run(height, band, [this](size_t y0, size_t y1) {
+		computeRows(y0, y1);
+	});
+}
+
+//--------------------------------------------------------------
+void DistanceField::computeRows(size_t y0, size_t y1) {
+	std::vector<float> crossings;
+
+	for (size_t y = y0; y < y1; y++) {
+		float * row = &distances[y * width];
+		float py = y + 0.5f;
+
+		std::fill(row, row + width, maxDistance);
+		crossings.clear();
+
+		for (const Segment & s : segments) {
+			// Inside test, half open so shared vertices count once
+			if ((s.a.y <= py) != (s.b.y <= py)) {
+				crossings.push_back(s.a.x + (py - s.a.y) * (s.b.x - s.a.x) / (s.b.y - s.a.y));
+			}
+
+			if (py < s.minY || py > s.maxY)
+				continue;
+
+			// Only pixel centres inside the band around the segment
+			float lo, hi;
+			if (!getSpan(s.a, s.b, s.offset, maxDistance, py, lo, hi))
+				continue;
+			int x0 = std::max(0, (int)std::ceil(lo - 0.5f));
+			int x1 = std::min((int)width - 1, (int)std::floor(hi - 0.5f));
+			if (x0 > x1)
+				continue;
+
+			glm::vec2 ab = s.b - s.a;
+			float len2 = glm::dot(ab, ab);
+			float invLen2 = len2 > 0 ? 1.f / len2 : 0.f;
+
+			for (int x = x0; x <= x1; x++) {
+				glm::vec2 ap(x + 0.5f - s.a.x, py - s.a.y);
+				float t = glm::clamp(glm::dot(ap, ab) * invLen2, 0.f, 1.f);
+				glm::vec2 d = ap - ab * t;
+				float dist2 = glm::dot(d, d);
+				if (dist2 < row[x] * row[x])
+					row[x] = std::sqrt(dist2);
+			}
+		}
+
+		// Negate spans between crossing pairs
+		std::sort(crossings.begin(), crossings.end());
+		for (size_t i = 0; i + 1 < crossings.size(); i += 2) {
+			int x0 = std::max(0, (int)std::ceil(crossings[i] - 0.5f));
+			int x1 = std::min((int)width, (int)std::ceil(crossings[i + 1] - 0.5f));
+			for (int x = x0; x < x1; x++) {
+				row[x] = -row[x];
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void DistanceField::fillCoverage(float radius, bool inverted, unsigned char * coverage) const {
+	float r = std::max(radius, 0.0001f);
+	for (size_t i = 0; i < distances.size(); i++) {
+		float t = glm::clamp(0.5f - 0.5f * distances[i] / r, 0.f, 1.f);
+		t = t * t * (3.f - 2.f * t);
+		if (inverted)
+			t = 1.f - t;
+		unsigned char c = (unsigned char)(t * 255.f + 0.5f);
+		if (c > coverage[i])
+			coverage[i] = c;
+	}
+}
+
+//--------------------------------------------------------------
+size_t DistanceField::getMemoryUsage() const {
+	return segments.capacity() * sizeof(Segment) + distances.capacity() * sizeof(float);
+}
+
+//--------------------------------------------------------------
+void DistanceField::compact() {
+	std::vector<Segment>().swap(segments);
+	distances.shrink_to_fit();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "glm/glm.hpp"
+
+// Band-limited signed distance field of closed contours, sampled at pixel centres.
+// Distances are exact to the nearest segment, negative inside (odd rule) and
+// clamped to +-maxDistance. Rows of large fields are split across a pool of threads
+// shared by all fields.
+class DistanceField {
+public:
+	void compute(const std::vector<std::vector<glm::vec2>> & contours, size_t width, size_t height, float maxDistance);
+
+	// Feathered coverage, fully covered radius pixels inside the edge and uncovered
+	// radius pixels outside it. Existing coverage is kept where higher.
+	void fillCoverage(float radius, bool inverted, unsigned char * coverage) const;
+
+	const std::vector<float> & getDistances() const { return distances; }
+	size_t getWidth() const { return width; }
+	size_t getHeight() const { return height; }
+
+	// Heap bytes of the distances and segments, by capacity
+	size_t getMemoryUsage() const;
+	// Release the segments and excess capacity, the distances are kept
+	void compact();
+
+private:
+	struct Segment {
+		glm::vec2 a;
+		glm::vec2 b;
+		float minY;
+		float maxY;
+		// Normal scaled to maxDistance, the sides of the band around the segment
+		glm::vec2 offset;
+	};
+
+	void computeRows(size_t y0, size_t y1);
+
+	std::vector<Segment> segments;
+	std::vector<float> distances;
+	size_t width = 0;
+	size_t height = 0;
+	float maxDistance = 0;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ofMain.h"
+#include "SpatialGrid.h"
 
 class DragHandle {
 public:
@@ -31,6 +32,7 @@ public:
 template<typename T = DragHandle>
 class HasHandlesT : public HasHandles {
 public:
+	// Call invalidateHandleIndex() after adding, removing or moving handles directly
 	vector<T> & getHandles() {
 		return handles;
 	}
@@ -48,19 +50,25 @@ public:
 	}
 
 	bool selectHandle(const glm::vec2 & p, float radius) {
-		bool selected = false;
-		for (T & h : handles) {
-			if (glm::distance(p, h.position) < radius)
-				selected = true;
+		updateHandleIndex();
+		candidates.clear();
+		handleIndex.query(p, radius, candidates);
+		for (size_t i : candidates) {
+			if (glm::distance(p, handles[i].position) < radius)
+				return true;
 		}
-		return selected;
+		return false;
 	}
 
 	virtual bool moveHandle(const glm::vec2 & delta) {
+		updateHandleIndex();
 		bool moved = false;
-		for (T & h : handles) {
+		for (size_t i = 0; i < handles.size(); i++) {
+			T & h = handles[i];
 			if (h.selected) {
+				glm::vec2 from = h.position;
 				moveHandle(h, delta);
+				handleIndex.move(i, from, h.position);
 				moved = true;
 			}
 		}
@@ -74,19 +82,24 @@ public:
 	}
 
 	bool grabHandle(const glm::vec2 & p, float radius) {
-		bool grabbed = false;
-		for (T & h : handles) {
+		updateHandleIndex();
+		for (size_t i : activeHandles) {
+			handles[i].selected = false;
+			handles[i].dragging = false;
+		}
+		activeHandles.clear();
+
+		candidates.clear();
+		handleIndex.query(p, radius, candidates);
+		for (size_t i : candidates) {
+			T & h = handles[i];
 			if (glm::distance(p, h.position) <= radius) {
-				grabbed = true;
 				h.selected = true;
 				h.dragging = true;
-			}
-			else {
-				h.selected = false;
-				h.dragging = false;
+				activeHandles.push_back(i);
 			}
 		}
-		return grabbed;
+		return !activeHandles.empty();
 	}
 	bool grabHandle(float x, float y, float radius) {
 		return grabHandle(glm::vec2(x, y), radius);
@@ -94,11 +107,15 @@ public:
 
 
 	void dragHandle(const glm::vec2 & delta) {
+		updateHandleIndex();
 		bool drag = false;
-		for (T & h : handles) {
+		for (size_t i : activeHandles) {
+			T & h = handles[i];
 			if (h.dragging) {
 				drag = true;
+				glm::vec2 from = h.position;
 				moveHandle(h, delta);
+				handleIndex.move(i, from, h.position);
 			}
 		}
 		if (drag) {
@@ -113,11 +130,142 @@ public:
 	virtual void notifyHandles() {}
 
 	void releaseHandle() {
-		for (T & h : handles) {
-			h.dragging = false;
+		updateHandleIndex();
+		for (size_t i : activeHandles) {
+			handles[i].dragging = false;
+		}
+	}
+
+	// Select handles inside rect or lasso, replacing the selection unless add is set
+	size_t selectHandles(const ofRectangle & rect, bool add = false) {
+		if (!add)
+			deselectHandles();
+		updateHandleIndex();
+		candidates.clear();
+		handleIndex.query(glm::vec2(rect.getMinX(), rect.getMinY()), glm::vec2(rect.getMaxX(), rect.getMaxY()), candidates);
+		for (size_t i : candidates) {
+			if (rect.inside(handles[i].position.x, handles[i].position.y))
+				addSelectedHandle(i);
+		}
+		return getNumSelectedHandles();
+	}
+
+	size_t selectHandles(const ofPolyline & lasso, bool add = false) {
+		if (!add)
+			deselectHandles();
+		if (lasso.size() < 3)
+			return getNumSelectedHandles();
+		updateHandleIndex();
+		ofRectangle rect = lasso.getBoundingBox();
+		candidates.clear();
+		handleIndex.query(glm::vec2(rect.getMinX(), rect.getMinY()), glm::vec2(rect.getMaxX(), rect.getMaxY()), candidates);
+		for (size_t i : candidates) {
+			if (lasso.inside(handles[i].position.x, handles[i].position.y))
+				addSelectedHandle(i);
+		}
+		return getNumSelectedHandles();
+	}
+
+	void deselectHandles() {
+		updateHandleIndex();
+		for (size_t i : activeHandles) {
+			handles[i].selected = false;
+			handles[i].dragging = false;
+		}
+		activeHandles.clear();
+	}
+
+	size_t getNumSelectedHandles() {
+		updateHandleIndex();
+		size_t n = 0;
+		for (size_t i : activeHandles) {
+			if (handles[i].selected)
+				n++;
+		}
+		return n;
+	}
+
+	ofRectangle getSelectedHandleBounds() {
+		updateHandleIndex();
+		ofRectangle bounds;
+		bool first = true;
+		for (size_t i : activeHandles) {
+			if (!handles[i].selected)
+				continue;
+			glm::vec3 p(handles[i].position, 0);
+			if (first)
+				bounds.set(p, 0, 0);
+			else
+				bounds.growToInclude(p);
+			first = false;
 		}
+		return bounds;
+	}
+
+	void invalidateHandleIndex() {
+		handleIndexDirty = true;
+	}
+
+	// Heap bytes of the handles and their index, by capacity
+	size_t getHandleMemoryUsage() const {
+		return handles.capacity() * sizeof(T) + handleIndex.getMemoryUsage()
+			+ (activeHandles.capacity() + candidates.capacity()) * sizeof(size_t)
+			+ positions.capacity() * sizeof(glm::vec2);
+	}
+
+	void compactHandles() {
+		handles.shrink_to_fit();
+		handleIndex.compact();
+		activeHandles.shrink_to_fit();
+		vector<size_t>().swap(candidates);
+		vector<glm::vec2>().swap(positions);
 	}
 
 protected:
+	// Rebuild the grid after handles were added, removed or moved outside drag/move
+	void updateHandleIndex() {
+		if (!handleIndexDirty && handleIndex.size() == handles.size())
+			return;
+
+		positions.clear();
+		for (auto & h : handles)
+			positions.push_back(h.position);
+		handleIndex.clear(SpatialGrid::getCellSize(positions));
+
+		activeHandles.clear();
+		for (size_t i = 0; i < handles.size(); i++) {
+			handleIndex.insert(i, handles[i].position);
+			if (handles[i].selected || handles[i].dragging)
+				activeHandles.push_back(i);
+		}
+		handleIndexDirty = false;
+	}
+
+	// Indices of handles that may be selected or dragging
+	const vector<size_t> & getActiveHandles() {
+		updateHandleIndex();
+		return activeHandles;
+	}
+
+	void setHandlePosition(size_t i, const glm::vec2 & p) {
+		handleIndex.move(i, handles[i].position, p);
+		handles[i].position = p;
+	}
+
 	vector<T> handles;
+
+private:
+	void addSelectedHandle(size_t i) {
+		T & h = handles[i];
+		if (!h.selected && !h.dragging)
+			activeHandles.push_back(i);
+		h.selected = true;
+	}
+
+	SpatialGrid handleIndex;
+	bool handleIndexDirty = true;
+	// Handles that may be selected or dragging, so grabbing doesn't walk all of them
+	vector<size_t> activeHandles;
+	vector<size_t> candidates;
+	vector<glm::vec2> positions;
 };
\ No newline at end of file
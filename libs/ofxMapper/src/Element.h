@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ofMain.h"
+#include "UniqueId.h"
 
 class Element {
 public:
@@ -28,7 +29,7 @@ public:
 		dragging = false;
 	}
 
-	string uniqueId;
+	UniqueId uniqueId;
 	ofParameter<string> name = { "Name:", "" };
 	ofParameter<bool> enabled = { "Enabled", true };
 	ofParameter<bool> editEnabled = { "Edit", false };
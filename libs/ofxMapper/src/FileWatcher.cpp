@@ -0,0 +1,143 @@
+#include "FileWatcher.h"
+
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <climits>
+#include <cstring>
+#endif
+
+//--------------------------------------------------------------
+FileWatcher::FileWatcher() {
+}
+
+//--------------------------------------------------------------
+FileWatcher::~FileWatcher() {
+	unwatch();
+}
+
+//--------------------------------------------------------------
+bool FileWatcher::watch(const std::string & filePath) {
+	unwatch();
+	this->filePath = filePath;
+
+#ifdef __linux__
+	// Watch the directory, saving by rename replaces the file and its watch
+	size_t slash = filePath.find_last_of('/');
+	std::string directory = slash == std::string::npos ? "." : filePath.substr(0, slash == 0 ? 1 : slash);
+	fileName = slash == std::string::npos ? filePath : filePath.substr(slash + 1);
+
+	fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd < 0)
+		return false;
+	wd = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+	if (wd < 0) {
+		close(fd);
+		fd = -1;
+		return false;
+	}
+#else
+	readStatus(size, time);
+	lastPoll = std::chrono::steady_clock::now();
+#endif
+
+	watching = true;
+	return true;
+}
+
+//--------------------------------------------------------------
+void FileWatcher::unwatch() {
+#ifdef __linux__
+	if (fd >= 0) {
+		if (wd >= 0)
+			inotify_rm_watch(fd, wd);
+		close(fd);
+	}
+	fd = -1;
+	wd = -1;
+#endif
+	watching = false;
+}
+
+//--------------------------------------------------------------
+bool FileWatcher::isWatching() const {
+	return watching;
+}
+
+//--------------------------------------------------------------
+const std::string & FileWatcher::getFilePath() const {
+	return filePath;
+}
+
+//--------------------------------------------------------------
+bool FileWatcher::hasChanged() {
+	if (!watching)
+		return false;
+
+#ifdef __linux__
+	bool changed = false;
+	alignas(struct inotify_event) char buffer[4096];
+	for (;;) {
+		ssize_t n = read(fd, buffer, sizeof(buffer));
+		if (n <= 0)
+			break;
+		for (char * p = buffer; p < buffer + n; ) {
+			const struct inotify_event * event = (const struct inotify_event *)p;
+			if (event->len && strcmp(event->name, fileName.c_str()) == 0)
+				changed = true;
+			p += sizeof(struct inotify_event) + event->len;
+		}
+	}
+	return changed;
+#else
+	auto now = std::chrono::steady_clock::now();
+	if (now - lastPoll < pollInterval)
+		return false;
+	lastPoll = now;
+
+	int64_t s, t;
+	if (!readStatus(s, t) || (s == size && t == time))
+		return false;
+	size = s;
+	time = t;
+	return true;
+#endif
+}
+
+//--------------------------------------------------------------
+void FileWatcher::setPollInterval(std::chrono::milliseconds interval) {
+	pollInterval = interval;
+}
+
+//--------------------------------------------------------------
+bool FileWatcher::readStatus(int64_t & size, int64_t & time) const {
+	size = -1;
+	time = -1;
+	// Sub-second times, an editor may save twice within a second without changing the size
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA status;
+	if (!GetFileAttributesExA(filePath.c_str(), GetFileExInfoStandard, &status))
+		return false;
+	size = ((int64_t)status.nFileSizeHigh << 32) | status.nFileSizeLow;
+	time = ((int64_t)status.ftLastWriteTime.dwHighDateTime << 32) | status.ftLastWriteTime.dwLowDateTime;
+#else
+	struct stat status;
+	if (stat(filePath.c_str(), &status) != 0)
+		return false;
+	size = status.st_size;
+#ifdef __APPLE__
+	time = (int64_t)status.st_mtimespec.tv_sec * 1000000000 + status.st_mtimespec.tv_nsec;
+#else
+	time = (int64_t)status.st_mtim.tv_sec * 1000000000 + status.st_mtim.tv_nsec;
+#endif
+#endif
+	return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <chrono>
+
+// Reports changes to a single file, including replacing it by renaming another file
+// over it. Uses inotify on Linux and polls size and modification time elsewhere.
+// Never blocks, meant to be asked once per frame.
+class FileWatcher {
+public:
+	FileWatcher();
+	~FileWatcher();
+
+	bool watch(const std::string & filePath);
+	void unwatch();
+	bool isWatching() const;
+	const std::string & getFilePath() const;
+
+	// True once for any number of changes since the last call
+	bool hasChanged();
+
+	// Time between polls where inotify is not available
+	void setPollInterval(std::chrono::milliseconds interval);
+
+private:
+	bool readStatus(int64_t & size, int64_t & time) const;
+
+	std::string filePath;
+	bool watching = false;
+
+#ifdef __linux__
+	int fd = -1;
+	int wd = -1;
+	std::string fileName;
+#else
+	int64_t size = -1;
+	int64_t time = -1;
+	std::chrono::steady_clock::time_point lastPoll;
+#endif
+	std::chrono::milliseconds pollInterval{ 250 };
+};
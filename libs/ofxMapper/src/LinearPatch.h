@@ -1,6 +1,5 @@
 #pragma once
 
-#include "Warper.h"
 #include "glm/glm.hpp"
 #include <vector>
 
@@ -1,4 +1,5 @@
 #include "LinearWarper.h"
+#include "Profiler.h"
 #include "LinearShader.h"
 #include "ColorCorrect.h"
 
@@ -28,6 +29,17 @@ void LinearWarper::setVertices(VerticesPtr v) {
     updateTexCoords();
 }
 
+//--------------------------------------------------------------
+void LinearWarper::clear() {
+    vertices.reset();
+    cols = 0;
+    rows = 0;
+    patches.clear();
+    outline.clear();
+    outlineBounds = ofRectangle();
+    mesh.clear();
+}
+
 //--------------------------------------------------------------
 VerticesPtr LinearWarper::subdivide(int subdivCols, int subdivRows) {
 
@@ -71,6 +83,7 @@ VerticesPtr LinearWarper::subdivide(int subdivCols, int subdivRows) {
 
 //--------------------------------------------------------------
 void LinearWarper::updatePatches() {
+	TraceScope trace("LinearWarper::updatePatches", "geometry");
     
     patches.resize(rows * cols);
     
@@ -147,6 +160,7 @@ void LinearWarper::drawMesh() {
     getShader().begin();
 	setShaderAttributes(shader);
 
+    ofxMapper::Profiler::countMesh(mesh);
     ofGetCurrentRenderer()->draw(mesh, OF_MESH_FILL, false, false, false);
 
 	disableShaderAttributes(shader);
@@ -196,7 +210,7 @@ const ofShader & LinearWarper::getShader() const {
 
 //--------------------------------------------------------------
 bool LinearWarper::select(const glm::vec2 & p) {
-    return outline.size() > 0 && outline.inside(p.x, p.y);
+    return outline.size() > 0 && outlineBounds.inside(p.x, p.y) && outline.inside(p.x, p.y);
 }
 
 //--------------------------------------------------------------
@@ -218,6 +232,19 @@ void LinearWarper::moveHandle(WarpHandle & handle, const glm::vec2 & delta) {
     }
 }
 
+//--------------------------------------------------------------
+void LinearWarper::getMemoryUsage(ofxMapper::MemoryUsage & usage) const {
+	// Patches hold the corner attributes of the mesh
+	usage.cpu[ofxMapper::MEMORY_MESHES] += patches.capacity() * sizeof(LinearPatch) + ofxMapper::getCapacityBytes(mesh) + ofxMapper::getCapacityBytes(outline);
+}
+
+//--------------------------------------------------------------
+void LinearWarper::compact() {
+	patches.shrink_to_fit();
+	ofxMapper::shrinkToFit(mesh);
+	ofxMapper::shrinkToFit(outline);
+}
+
 //--------------------------------------------------------------
 void LinearWarper::updatePatchVertices(int col, int row) {
     int c1 = col * 3;
@@ -279,6 +306,7 @@ void LinearWarper::makeOutline() {
         rowIndex -= cols;
     }
     outline.close();
+    outlineBounds = outline.getBoundingBox();
 }
 
 //--------------------------------------------------------------
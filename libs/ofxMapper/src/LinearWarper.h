@@ -12,6 +12,7 @@ public:
     void setVertices(VerticesPtr vertices);
 
     VerticesPtr subdivide(int cols, int rows);
+    void clear();
 
     void updatePatches();
     void updateTexCoords();
@@ -29,6 +30,9 @@ public:
 
 	void moveHandle(WarpHandle & handle, const glm::vec2 & delta);
 
+	void getMemoryUsage(ofxMapper::MemoryUsage & usage) const;
+	void compact();
+
 private:
     void updatePatchVertices(int col, int row);
 
@@ -48,6 +52,7 @@ private:
     vector<LinearPatch> patches;
 
     ofPolyline outline;
+    ofRectangle outlineBounds;
 
     static ofShader shader;
     ofMesh mesh;
@@ -1,4 +1,5 @@
 #include "Mapper.h"
+#include <unordered_set>
 
 using namespace ofxMapper;
 
@@ -32,9 +33,33 @@ void Mapper::end(bool doUpdate) {
 
 //--------------------------------------------------------------
 void Mapper::update(ofTexture & texture) {
-    
+
+	Profiler::endFrame();
+	ProfileScope scope(STAGE_UPDATE);
+
+	updateLoad();
+	updateWatch();
+	flush();
+	unsigned int rebuilds = getRebuildCount();
+	frameRebuildCount = rebuilds >= lastRebuildCount ? rebuilds - lastRebuildCount : rebuilds;
+	lastRebuildCount = rebuilds;
+
     updateBlendRects();
 
+	if (directEnabled) {
+		directTexture = &texture;
+		for (auto & screen : screens) {
+			if (screen->isFboRequired())
+				screen->update(texture);
+		}
+		return;
+	}
+
+	if (atlasEnabled && atlas.update(screens)) {
+		atlas.render(screens, texture);
+		return;
+	}
+
 	for (auto & screen : screens) {
 		screen->update(texture);
 	}
@@ -42,13 +67,161 @@ void Mapper::update(ofTexture & texture) {
 
 //--------------------------------------------------------------
 void Mapper::draw() {
+	ProfileScope scope(STAGE_DRAW);
+	flush();
 	for (auto & screen : screens) {
 		if (screen->enabled) {
-			screen->draw();
+			// No frame buffer to draw before the first update
+			if (directEnabled && !screen->isFboRequired()) {
+				if (directTexture)
+					screen->drawDirect(*directTexture);
+			}
+			else {
+				screen->draw();
+			}
 		}
 	}
 }
 
+//--------------------------------------------------------------
+void Mapper::flush() {
+	ProfileScope scope(STAGE_FLUSH);
+	for (auto & screen : screens) {
+		screen->flush();
+	}
+}
+
+//--------------------------------------------------------------
+unsigned int Mapper::getRebuildCount() const {
+	unsigned int n = 0;
+	for (auto & screen : screens) {
+		n += screen->getRebuildCount();
+	}
+	return n;
+}
+
+//--------------------------------------------------------------
+unsigned int Mapper::getFrameRebuildCount() const {
+	return frameRebuildCount;
+}
+
+//--------------------------------------------------------------
+void Mapper::setDirectEnabled(bool enabled) {
+	directEnabled = enabled;
+	directTexture = NULL;
+	// Frame buffers are released first, so leaving the atlas doesn't allocate them
+	for (auto & screen : screens) {
+		screen->setDirect(directEnabled);
+	}
+	if (directEnabled)
+		atlas.clear(screens);
+}
+
+//--------------------------------------------------------------
+bool Mapper::isDirectEnabled() const {
+	return directEnabled;
+}
+
+//--------------------------------------------------------------
+void Mapper::setHeadless(bool headless) {
+	this->headless = headless;
+}
+
+//--------------------------------------------------------------
+bool Mapper::isHeadless() const {
+	return headless;
+}
+
+//--------------------------------------------------------------
+void Mapper::setProfilingEnabled(bool enabled) {
+	Profiler::setEnabled(enabled);
+}
+
+//--------------------------------------------------------------
+bool Mapper::isProfilingEnabled() const {
+	return Profiler::isEnabled();
+}
+
+//--------------------------------------------------------------
+const FrameStats & Mapper::getFrameStats() const {
+	return Profiler::getFrameStats();
+}
+
+//--------------------------------------------------------------
+void Mapper::setTracingEnabled(bool enabled) {
+	if (enabled)
+		Tracer::setThreadName("main");
+	Tracer::setEnabled(enabled);
+}
+
+//--------------------------------------------------------------
+bool Mapper::isTracingEnabled() const {
+	return Tracer::isEnabled();
+}
+
+//--------------------------------------------------------------
+bool Mapper::saveTrace(string filePath) {
+	if (!Tracer::save(ofToDataPath(filePath))) {
+		ofLogError("ofxMapper") << "Could not write trace " << filePath;
+		return false;
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+void Mapper::clearTrace() {
+	Tracer::clear();
+}
+
+//--------------------------------------------------------------
+MemoryUsage Mapper::getMemoryUsage() const {
+	MemoryUsage usage;
+	usage.gpu[MEMORY_FBOS] += getGpuBytes(fbo);
+	atlas.getMemoryUsage(usage);
+
+	// Luts are shared between screens and slices, count each once
+	unordered_set<const void *> luts;
+	auto addColorLut = [&](const ColorLutPtr & lut) {
+		if (lut && luts.insert(lut.get()).second)
+			lut->getMemoryUsage(usage);
+	};
+	for (auto & screen : screens) {
+		usage += screen->getMemoryUsage();
+		addColorLut(screen->getColorLut());
+		for (auto & slice : screen->getSlices()) {
+			addColorLut(slice->getColorCorrect().getLut());
+			const BlendLutPtr & blendLut = slice->getSoftEdge().getBlendLut();
+			if (blendLut && luts.insert(blendLut.get()).second)
+				blendLut->getMemoryUsage(usage);
+		}
+	}
+	return usage;
+}
+
+//--------------------------------------------------------------
+void Mapper::compact() {
+	for (auto & screen : screens) {
+		screen->compact();
+	}
+}
+
+//--------------------------------------------------------------
+void Mapper::setAtlasEnabled(bool enabled) {
+	atlasEnabled = enabled;
+	if (!atlasEnabled)
+		atlas.clear(screens);
+}
+
+//--------------------------------------------------------------
+bool Mapper::isAtlasEnabled() const {
+	return atlasEnabled;
+}
+
+//--------------------------------------------------------------
+const ofFbo & Mapper::getAtlasFbo() const {
+	return atlas.getFbo();
+}
+
 //--------------------------------------------------------------
 void Mapper::drawComp() {
 	fbo.draw(0, 0);
@@ -82,7 +255,10 @@ void Mapper::drawInputRectsSelected(bool drawDisabled) {
 
 //--------------------------------------------------------------
 void Mapper::setCompSize(size_t width, size_t height) {
-	fbo.allocate(width, height, GL_RGBA);
+	if (!headless) {
+		fbo.allocate(width, height, GL_RGBA);
+		Profiler::count(COUNTER_ALLOCATIONS);
+	}
 	compRect.set(0, 0, width, height);
 }
 
@@ -111,13 +287,14 @@ ScreenPtr Mapper::getScreen(size_t screenIndex) {
 	return screens[screenIndex];
 }
 
+//--------------------------------------------------------------
+ScreenPtr Mapper::getScreen(const UniqueId & uniqueId) {
+	return screenIndex.find(screens, uniqueId);
+}
+
 //--------------------------------------------------------------
 ScreenPtr Mapper::getScreen(string uniqueId) {
-	for (ScreenPtr screen : screens) {
-		if (screen->uniqueId == uniqueId)
-			return screen;
-	}
-	return NULL;
+	return getScreen(UniqueId::parse(uniqueId));
 }
 
 //--------------------------------------------------------------
@@ -134,17 +311,28 @@ ScreenPtr Mapper::addScreen(string name, int width, int height) {
 		x = rect.getRight();
 		y = rect.getTop();
 	}
-    screens.emplace_back(new Screen(x, y, width, height));
-    ScreenPtr screen = screens.back();
+	ScreenPtr screen = makeScreen(x, y, width, height);
 	screen->name = name;
+	screenIndex.insert(screen);
 	return screen;
 }
 
 //--------------------------------------------------------------
 ScreenPtr Mapper::addScreen(string name, int x, int y, int width, int height) {
-	screens.emplace_back(new Screen(x, y, width, height));
-	ScreenPtr screen = screens.back();
+	ScreenPtr screen = makeScreen(x, y, width, height);
 	screen->name = name;
+	screenIndex.insert(screen);
+	return screen;
+}
+
+//--------------------------------------------------------------
+ScreenPtr Mapper::makeScreen(int x, int y, int width, int height) {
+	// Allocated after the mode is set, so direct mode doesn't allocate a frame buffer first
+	ScreenPtr screen(new Screen(x, y, width, height, false));
+	screen->setDirect(directEnabled);
+	if (!headless)
+		screen->allocate();
+	screens.push_back(screen);
 	return screen;
 }
 
@@ -153,6 +341,8 @@ void Mapper::removeScreen() {
 	for (auto it = screens.begin(); it != screens.end();) {
 		auto p = it[0];
 		if (p->remove) {
+			p->setAtlas(NULL, ofRectangle());
+			screenIndex.erase(p);
 			it = screens.erase(it);
 		}
 		else {
@@ -166,6 +356,8 @@ void Mapper::removeScreen(ScreenPtr screen) {
 	for (auto it = screens.begin(); it != screens.end();) {
 		auto p = it[0];
 		if (p == screen) {
+			p->setAtlas(NULL, ofRectangle());
+			screenIndex.erase(p);
 			it = screens.erase(it);
 		}
 		else {
@@ -177,6 +369,7 @@ void Mapper::removeScreen(ScreenPtr screen) {
 //--------------------------------------------------------------
 void Mapper::clearScreens() {
 	screens.clear();
+	screenIndex.clear();
 }
 
 //--------------------------------------------------------------
@@ -261,6 +454,7 @@ void ofxMapper::Mapper::releaseInputHandle() {
 
 //--------------------------------------------------------------
 void Mapper::updateBlendRects() {
+	ProfileScope scope(STAGE_BLEND_RECTS);
     size_t n = getNumScreens();
     for (size_t i = 0; i < n; i++) {
         ScreenPtr screen1 = getScreen(i);
@@ -312,163 +506,313 @@ void ofxMapper::Mapper::clear() {
 	compFilePath = "untitled.xml";
 	compFile.reset();
 	screens.clear();
+	screenIndex.clear();
+	fileData.clear();
+	watcher.unwatch();
+	reloader.reset();
 }
 
 //--------------------------------------------------------------
 bool Mapper::load(string filePath) {
 
-	compFile = shared_ptr<ResolumeFile>(new ResolumeFile);
-	bool loaded = compFile->load(filePath);
+	cancelLoad();
 
-	if (!loaded) {
-		ofLogError("ofxMapper") << "Unable to load file: " << filePath;
+	CompositionLoader loader;
+	if (!loader.read(filePath, cacheEnabled)) {
 		compFile.reset();
 		return false;
 	}
+	loader.build(loader.getData());
+	swapIn(loader);
 
-	if (!compFile->isValid("Resolume Arena") && !compFile->isValid("ofxMapper")) {
-		ofLogError("ofxMapper") << "File not valid: " << filePath;
-		compFile.reset();
-		return false;
+	return true;
+}
+
+//--------------------------------------------------------------
+void Mapper::loadAsync(string filePath) {
+	cancelLoad();
+	loader = make_shared<CompositionLoader>();
+	loadState = CompositionLoader::LOAD_RUNNING;
+	numAllocated = 0;
+	loader->start(filePath, cacheEnabled);
+}
+
+//--------------------------------------------------------------
+void Mapper::cancelLoad() {
+	if (loader) {
+		loader->cancel();
+		loader.reset();
+		loadState = CompositionLoader::LOAD_CANCELLED;
 	}
+}
 
-	// Composition
-	ofRectangle r = compFile->getCompositionSize();
-	setCompSize(r.width, r.height);
+//--------------------------------------------------------------
+bool Mapper::isLoading() const {
+	return loader != NULL;
+}
 
-	// Screens
-	screens.clear();
-	int nscreens = compFile->loadScreens();
-	for (int i = 0; i < nscreens; i++) {
-		ResolumeFile::Screen sc = compFile->getScreen(i);
-		ofRectangle res = sc.getSize();
-		ScreenPtr screen = addScreen(res.width, res.height);
-		screen->uniqueId = sc.getUniqueId();
-		screen->name = sc.getName();
-		screen->enabled = sc.getEnabled();
-
-		// Slices
-		int nslices = sc.getNumSlices();
-		for (int j = 0; j < nslices; j++) {
-			ResolumeFile::Slice sl = sc.getSlice(j);
-			string name = sl.getName();
-			ofRectangle inputRect = sl.getInputRect();
-			SlicePtr slice = screen->addSlice(name, inputRect);
-			slice->uniqueId = sl.getUniqueId();
-			slice->enabled = sl.getEnabled();
-			slice->softEdgeEnabled = sl.getSoftEdgeEnabled();
-
-			SoftEdge & softEdge = slice->getSoftEdge();
-			softEdge.power = sl.getSoftEdgePower(softEdge.power);
-			softEdge.luminance = sl.getSoftEdgeLuminance(softEdge.luminance);
-			softEdge.gamma = sl.getSoftEdgeGamma(softEdge.gamma);
-
-			slice->setInputRect(inputRect);
-			slice->bezierEnabled = sl.getWarperMode() == "PM_BEZIER";
-
-			int w = 0, h = 0;
-			sl.getWarperDim(w, h);
-			auto vertices = sl.getWarperVertices();
-			slice->setVertices(vertices, w, h);
-		}
+//--------------------------------------------------------------
+CompositionLoader::State Mapper::getLoadState() const {
+	if (!loader)
+		return loadState;
+	CompositionLoader::State state = loader->getState();
+	return state == CompositionLoader::LOAD_READY ? CompositionLoader::LOAD_RUNNING : state;
+}
 
-		// Masks
-		int nmasks = sc.getNumMasks();
-		for (int j = 0; j < nmasks; j++) {
-			ResolumeFile::Mask msk = sc.getMask(j);
-			string name = msk.getName();
-			auto points = msk.getPoints();
-
-			MaskPtr mask = screen->addMask(name);
-			mask->uniqueId = msk.getUniqueId();
-			mask->enabled = msk.getEnabled();
-			mask->closed = msk.getClosed();
-			mask->setPoints(points);
-		}
+//--------------------------------------------------------------
+float Mapper::getLoadProgress() const {
+	if (!loader)
+		return loadState == CompositionLoader::LOAD_READY ? 1 : 0;
+
+	// Frame buffer allocation takes the last tenth
+	float progress = loader->getProgress() * 0.9f;
+	if (loader->getState() == CompositionLoader::LOAD_READY && !loader->getScreens().empty())
+		progress += 0.1f * numAllocated / loader->getScreens().size();
+	return progress;
+}
+
+//--------------------------------------------------------------
+void Mapper::setLoadBudget(float milliseconds) {
+	loadBudget = milliseconds;
+}
+
+//--------------------------------------------------------------
+void Mapper::updateLoad() {
+
+	if (!loader)
+		return;
+
+	CompositionLoader::State state = loader->getState();
+	if (state == CompositionLoader::LOAD_RUNNING)
+		return;
+	if (state != CompositionLoader::LOAD_READY) {
+		loadState = state;
+		loader.reset();
+		return;
 	}
-	compFilePath = filePath;
 
-	return true;
+	// The worker is done, allocate within the budget and keep drawing the current screens meanwhile
+	vector<ScreenPtr> & newScreens = loader->getScreens();
+	uint64_t startTime = ofGetElapsedTimeMicros();
+	while (numAllocated < newScreens.size()) {
+		newScreens[numAllocated]->setDirect(directEnabled);
+		newScreens[numAllocated++]->allocate();
+		if (ofGetElapsedTimeMicros() - startTime >= loadBudget * 1000)
+			break;
+	}
+	if (numAllocated < newScreens.size())
+		return;
+
+	swapIn(*loader);
+	loader.reset();
+	loadState = CompositionLoader::LOAD_READY;
 }
 
 //--------------------------------------------------------------
-void ofxMapper::Mapper::save(string filePath) {
+void Mapper::swapIn(CompositionLoader & loader) {
+	TraceScope trace("Mapper::swapIn", "load");
 
-	//ResolumeFile saver(xml);
-	if (!compFile) {
-		compFile = shared_ptr<ResolumeFile>(new ResolumeFile);
-		compFile->setVersion("ofxMapper");
+	setScreens(loader.getScreens());
+
+	// Reallocating clears the composition, only do it when the size changes
+	ofRectangle r = loader.getCompositionSize();
+	if ((!headless && !fbo.isAllocated()) || r.width != compRect.width || r.height != compRect.height)
+		setCompSize(r.width, r.height);
+
+	// The DOM is only built if the file is saved
+	compFile = shared_ptr<ResolumeFile>(new ResolumeFile);
+	compFile->setSource(std::move(loader.getSource()));
+	writer.reset(compFile, loader.getData());
+	compFilePath = loader.getFilePath();
+	fileData = std::move(loader.getData());
+
+	// Changes seen before this load are already in it
+	reloader.reset();
+	reloadPending = false;
+	if (watchEnabled)
+		watcher.watch(compFilePath);
+
+	loadStats = loader.getStats();
+	ofLogNotice("ofxMapper") << "Loaded " << compFilePath << ": "
+		<< loadStats.numScreens << " screens, " << loadStats.numSlices << " slices, " << loadStats.numMasks << " masks. "
+		<< (loadStats.cached ? "Cache " : "Parse ") << loadStats.parse << "s, construct " << loadStats.construct << "s, build " << loadStats.build << "s";
+}
+
+//--------------------------------------------------------------
+size_t Mapper::reload() {
+	// Read what our last save wrote, not the file before it
+	writer.wait();
+	CompositionLoader loader;
+	if (!loader.read(compFilePath, cacheEnabled))
+		return 0;
+	return merge(loader);
+}
+
+//--------------------------------------------------------------
+void Mapper::setWatchEnabled(bool enabled) {
+	watchEnabled = enabled;
+	if (watchEnabled && compFile)
+		watcher.watch(compFilePath);
+	else
+		watcher.unwatch();
+}
+
+//--------------------------------------------------------------
+bool Mapper::isWatchEnabled() const {
+	return watchEnabled;
+}
+
+//--------------------------------------------------------------
+void Mapper::updateWatch() {
+
+	if (!watchEnabled)
+		return;
+
+	if (watcher.hasChanged())
+		reloadPending = true;
+
+	if (reloader) {
+		CompositionLoader::State state = reloader->getState();
+		if (state == CompositionLoader::LOAD_RUNNING)
+			return;
+		// Our own saves also show up as changes, tell them by the hash of what was written.
+		// A save in progress may be what was read, its hash is known once it is done.
+		if (state == CompositionLoader::LOAD_READY && writer.isBusy())
+			return;
+		// A file caught half written fails to parse, the rest of it comes with another change
+		if (state == CompositionLoader::LOAD_READY && !writer.wasWritten(reloader->getSourceHash()))
+			merge(*reloader);
+		reloader.reset();
 	}
 
-	compFile->setCompositionSize(compRect.width, compRect.height);
+	// A full load in progress replaces everything anyway
+	if (reloadPending && !loader) {
+		reloadPending = false;
+		reloader = make_shared<CompositionLoader>();
+		reloader->start(compFilePath, cacheEnabled, false);
+	}
+}
+
+//--------------------------------------------------------------
+size_t Mapper::merge(CompositionLoader & loader) {
+	TraceScope trace("Mapper::merge", "load");
+
+	uint64_t startTime = ofGetElapsedTimeMicros();
+	vector<ScreenData> & next = loader.getData();
+	size_t changes = 0;
+
+	unordered_map<UniqueId, const ScreenData *> previous;
+	for (auto & data : fileData) {
+		previous[data.uniqueId] = &data;
+	}
 
-	// Remove deleted screens
-	int nb_screens = compFile->loadScreens();
-	for (int i = 0; i < nb_screens; i++) {
-		ResolumeFile::Screen scr = compFile->getScreen(i);
-		string uniqueId = scr.getUniqueId();
-		if (getScreen(uniqueId) == NULL) {
-			compFile->removeScreen(uniqueId);
+	// Screens without an id can't be matched and are left out
+	const ScreenData none;
+	bool added = false;
+	for (auto & data : next) {
+		if (!data.uniqueId.isValid())
+			continue;
+		const ScreenData * p = &none;
+		auto it = previous.find(data.uniqueId);
+		if (it != previous.end()) {
+			p = it->second;
+			previous.erase(it);
+		}
+		ScreenPtr screen = getScreen(data.uniqueId);
+		if (!screen) {
+			screen = addScreen(data.name, data.width, data.height);
+			screen->uniqueId = data.uniqueId;
+			added = true;
+		}
+		changes += screen->merge(*p, data);
+	}
+	// Whatever is left was removed
+	for (auto & p : previous) {
+		ScreenPtr screen = getScreen(p.first);
+		if (screen) {
+			removeScreen(screen);
+			changes++;
 		}
 	}
-	compFile->loadScreens();
+	if (added)
+		screenIndex.rebuild(screens);
 
+	ofRectangle r = loader.getCompositionSize();
+	if (r.width != compRect.width || r.height != compRect.height)
+		setCompSize(r.width, r.height);
 
-	for (auto & screen : screens) {
-		ResolumeFile::Screen scr = compFile->getScreen(screen->uniqueId);
-		scr.setName(screen->name);
-		scr.setEnabled(screen->enabled);
-
-		// Remove deleted slices
-		int nb_slices = scr.loadSlices();
-		for (int i = 0; i < nb_slices; i++) {
-			ResolumeFile::Slice slc = scr.getSlice(i);
-			string uniqueId = slc.getUniqueId();
-			if (screen->getSlice(uniqueId) == NULL) {
-				scr.removeSlice(uniqueId);
-			}
-		}
-		scr.loadSlices();
+	// Later saves start from the new document. A snapshot still queued was taken before
+	// the merge, save the merged model instead.
+	compFile = shared_ptr<ResolumeFile>(new ResolumeFile);
+	compFile->setSource(std::move(loader.getSource()));
+	bool dropped = writer.reset(compFile, next);
+	fileData = std::move(next);
+	if (dropped)
+		save();
 
-		for (auto & slice : screen->getSlices()) {
-			ResolumeFile::Slice slc = scr.getSlice(slice->uniqueId);
-			slc.setName(slice->name);
-			slc.setEnabled(slice->enabled);
-			slc.setInputRect(slice->getInputRect());
-			slc.setWarperMode(slice->bezierEnabled ? "PM_BEZIER" : "PM_LINEAR");
+	ofLogNotice("ofxMapper") << "Reloaded " << compFilePath << ": " << changes << " changes in "
+		<< (ofGetElapsedTimeMicros() - startTime) / 1000.f << "ms";
 
-			slc.setWarperVertices(slice->getControlWidth(), slice->getControlHeight(), slice->getVertices());
-		}
+	return changes;
+}
 
-		// Remove deleted masks
-		int nb_masks = scr.loadMasks();
-		for (int i = 0; i < nb_masks; i++) {
-			ResolumeFile::Mask msk = scr.getMask(i);
-			string uniqueId = msk.getUniqueId();
-			if (screen->getMask(uniqueId) == NULL) {
-				scr.removeMask(uniqueId);
-			}
-		}
-		scr.loadMasks();
+//--------------------------------------------------------------
+void Mapper::setScreens(vector<ScreenPtr> & newScreens) {
 
-		for (auto & mask : screen->getMasks()) {
-			ResolumeFile::Mask msk = scr.getMask(mask->uniqueId);
-			msk.setName(mask->name);
-			msk.setEnabled(mask->enabled);
-			msk.setInverted(mask->inverted);
+	// Allocate whatever is still pending, then replace all screens at once. The old
+	// screens are released here, on the render thread.
+	for (auto & screen : newScreens) {
+		screen->setDirect(directEnabled);
+		if (!headless)
+			screen->allocate();
+	}
+	screens.swap(newScreens);
+	newScreens.clear();
+	screenIndex.rebuild(screens);
+}
 
-			vector<glm::vec2> points;
-			for (auto & h : mask->getHandles()) {
-				points.push_back(h.position);
-			}
-			msk.setPoints(points, mask->closed);
-		}
+//--------------------------------------------------------------
+void Mapper::setCacheEnabled(bool enabled) {
+	cacheEnabled = enabled;
+}
+
+//--------------------------------------------------------------
+bool Mapper::isCacheEnabled() const {
+	return cacheEnabled;
+}
+
+//--------------------------------------------------------------
+void Mapper::loadScreens(const vector<ScreenData> & data) {
+	CompositionLoader loader;
+	loader.build(data);
+	setScreens(loader.getScreens());
+	loadStats = loader.getStats();
+}
+
+//--------------------------------------------------------------
+const LoadStats & Mapper::getLoadStats() const {
+	return loadStats;
+}
+
+//--------------------------------------------------------------
+void ofxMapper::Mapper::save(string filePath) {
 
-		scr.setSize(screen->width, screen->height);
+	if (!compFile) {
+		compFile = shared_ptr<ResolumeFile>(new ResolumeFile);
+		compFile->setVersion("ofxMapper");
+		writer.reset(compFile, vector<ScreenData>());
 	}
 
-	if (compFile->save(filePath))
-		compFilePath = filePath;
+	// Copy out on this thread, compare and write on the writer's
+	vector<ScreenData> data(screens.size());
+	for (size_t i = 0; i < screens.size(); i++) {
+		screens[i]->get(data[i]);
+	}
+	fileData = data;
+	writer.save(filePath, compRect, std::move(data));
+	if (watchEnabled && (filePath != compFilePath || !watcher.isWatching()))
+		watcher.watch(filePath);
+	compFilePath = filePath;
 }
 
 //--------------------------------------------------------------
@@ -476,6 +820,16 @@ void ofxMapper::Mapper::save() {
 	save(compFilePath);
 }
 
+//--------------------------------------------------------------
+bool Mapper::isSaving() {
+	return writer.isBusy();
+}
+
+//--------------------------------------------------------------
+void Mapper::waitForSave() {
+	writer.wait();
+}
+
 //--------------------------------------------------------------
 string Mapper::getFileName() const {
 	return ofFilePath::getFileName(compFilePath);
@@ -3,6 +3,12 @@
 #include "ofMain.h"
 #include "Screen.h"
 #include "ResolumeFile.h"
+#include "CompositionWriter.h"
+#include "CompositionLoader.h"
+#include "FileWatcher.h"
+#include "ScreenAtlas.h"
+#include "MapperData.h"
+#include "Profiler.h"
 
 namespace ofxMapper {
 
@@ -23,6 +29,50 @@ namespace ofxMapper {
 		// Draw mapped content
 		void draw();
 
+		// Handle drags only mark geometry dirty. Dirty slices and masks are rebuilt
+		// once here, called from update() and draw().
+		void flush();
+		// Geometry rebuilds since creation, and between the last two update() calls
+		unsigned int getRebuildCount() const;
+		unsigned int getFrameRebuildCount() const;
+
+		// Draw slices and masks straight to the output in draw(), skipping the screen frame buffers.
+		// Screens with multisampling or Screen::setFboRequired still render to their frame buffer,
+		// the others release it. Each screen rect is cleared to black before its slices are drawn.
+		// The texture passed to update() must stay valid until draw(). Takes precedence over atlas mode.
+		void setDirectEnabled(bool enabled);
+		bool isDirectEnabled() const;
+
+		// Build screens without frame buffers and skip all GL work, to use the geometry without
+		// a GL context, e.g. on calibration nodes or in benchmarks. update() and draw() must not be called.
+		void setHeadless(bool headless);
+		bool isHeadless() const;
+
+		// Stage timings and draw counters, a frame being the time between update() calls. Costs
+		// a flag check per stage while disabled. Shared by all mappers, see Profiler.
+		void setProfilingEnabled(bool enabled);
+		bool isProfilingEnabled() const;
+		const FrameStats & getFrameStats() const;
+
+		// Timeline of loads, saves, geometry rebuilds and frame stages, written as
+		// Chrome trace JSON for chrome://tracing or Perfetto. Shared by all mappers, see Tracer.
+		void setTracingEnabled(bool enabled);
+		bool isTracingEnabled() const;
+		bool saveTrace(string filePath);
+		void clearTrace();
+
+		// CPU and GPU bytes by category over all screens, frame buffers and luts, counting
+		// capacity. Per object, see Screen, Slice and Mask.
+		MemoryUsage getMemoryUsage() const;
+		// Shrink the buffers of all screens to fit. Costs reallocations on the next edits,
+		// meant for players that load a composition once.
+		void compact();
+
+		// Render all screens into one shared frame buffer instead of one per screen
+		void setAtlasEnabled(bool enabled);
+		bool isAtlasEnabled() const;
+		const ofFbo & getAtlasFbo() const;
+
 
 		////////////////////////////////////////////////////////////
 
@@ -31,8 +81,42 @@ namespace ofxMapper {
 
 		void clear();
 		bool load(string filePath);
+		// Read and build the composition on a worker thread while the current screens keep
+		// rendering. update() then allocates frame buffers for the new screens a few at a
+		// time and swaps them all in at once. Cancels a load in progress.
+		void loadAsync(string filePath);
+		// Waits for the worker to reach the next screen, slice or mask
+		void cancelLoad();
+		bool isLoading() const;
+		// LOAD_RUNNING until the new screens are swapped in, LOAD_READY after
+		CompositionLoader::State getLoadState() const;
+		float getLoadProgress() const;
+		// Time spent allocating frame buffers for an async load per update(), at least one per frame
+		void setLoadBudget(float milliseconds);
+		// Read the file again and apply only what changed in it since the last load, save or
+		// reload, matching screens, slices and masks by uniqueId. Everything else keeps its
+		// meshes, frame buffers and unsaved edits. Returns the number of changes.
+		size_t reload();
+		// Watch the current file and reload() on a worker thread whenever it changes,
+		// the changes are applied in update()
+		void setWatchEnabled(bool enabled);
+		bool isWatchEnabled() const;
+		// Replace all screens with the described ones. Geometry is built once at the end,
+		// in parallel across slices and masks.
+		void loadScreens(const vector<ScreenData> & data);
+		// Phase timings of the last load
+		const LoadStats & getLoadStats() const;
+		// Keep a binary snapshot next to loaded files (file path + ".cache") and load from it
+		// while the XML is unchanged
+		void setCacheEnabled(bool enabled);
+		bool isCacheEnabled() const;
+		// Snapshot the model and write it on a background thread. Only screens, slices
+		// and masks changed since the last save or load are rewritten.
 		void save(string filePath);
 		void save();
+		bool isSaving();
+		// Block until pending saves are written
+		void waitForSave();
 		string getFileName() const;
 		string getFilePath() const;
 
@@ -50,6 +134,7 @@ namespace ofxMapper {
 		vector<ScreenPtr> & getScreens();
 		size_t getNumScreens() const;
 		ScreenPtr getScreen(size_t screenIndex = 0);
+		ScreenPtr getScreen(const UniqueId & uniqueId);
 		ScreenPtr getScreen(string uniqueId);
 		ScreenPtr addScreen(int width, int height);
 		ScreenPtr addScreen(string name, int width, int height);
@@ -74,15 +159,51 @@ namespace ofxMapper {
 		void drawBlendRects();
 
 	private:
+		void updateLoad();
+		void swapIn(CompositionLoader & loader);
+		void setScreens(vector<ScreenPtr> & newScreens);
+		// Append a screen set up for the current mode
+		ScreenPtr makeScreen(int x, int y, int width, int height);
+		void updateWatch();
+		size_t merge(CompositionLoader & loader);
+
 		ofRectangle compRect;
 
 		shared_ptr<ResolumeFile> compFile;
+		CompositionWriter writer;
 		string compFilePath = "untitled.xml";
 
 		// Frame buffer
 		ofFbo fbo;
 
+		bool headless = false;
+
+		bool directEnabled = false;
+		ofTexture * directTexture = NULL;
+
+		bool atlasEnabled = false;
+		ScreenAtlas atlas;
+
 		vector<ScreenPtr> screens;
+		UniqueIdIndex<Screen> screenIndex;
+
+		LoadStats loadStats;
+		bool cacheEnabled = false;
+
+		CompositionLoaderPtr loader;
+		CompositionLoader::State loadState = CompositionLoader::LOAD_IDLE;
+		size_t numAllocated = 0;
+		float loadBudget = 2;
+
+		// What the file held at the last load, save or reload
+		vector<ScreenData> fileData;
+		bool watchEnabled = false;
+		FileWatcher watcher;
+		CompositionLoaderPtr reloader;
+		bool reloadPending = false;
+
+		unsigned int lastRebuildCount = 0;
+		unsigned int frameRebuildCount = 0;
 	};
 
 }
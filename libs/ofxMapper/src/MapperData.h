@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "glm/glm.hpp"
+#include "UniqueId.h"
+#include "Rect.h"
+
+namespace ofxMapper {
+
+	// Plain descriptions of screens, slices and masks, used to construct
+	// a whole composition at once with Mapper::loadScreens
+
+	struct SliceData {
+		UniqueId uniqueId;
+		std::string name;
+		bool enabled = true;
+		Rect inputRect;
+		bool bezierEnabled = false;
+		bool softEdgeEnabled = false;
+		float softEdgePower = 2;
+		float softEdgeLuminance = 0.5;
+		float softEdgeGamma = 1;
+		// Control points, controlWidth * controlHeight. Empty for a default grid over the screen.
+		std::vector<glm::vec2> vertices;
+		size_t controlWidth = 0;
+		size_t controlHeight = 0;
+	};
+
+	struct MaskData {
+		UniqueId uniqueId;
+		std::string name;
+		bool enabled = true;
+		bool closed = true;
+		bool inverted = false;
+		float feather = 0;
+		std::vector<glm::vec2> points;
+	};
+
+	struct ScreenData {
+		UniqueId uniqueId;
+		std::string name;
+		bool enabled = true;
+		int width = 1920;
+		int height = 1080;
+		std::vector<SliceData> slices;
+		std::vector<MaskData> masks;
+	};
+
+	inline bool operator==(const SliceData & a, const SliceData & b) {
+		return a.uniqueId == b.uniqueId && a.name == b.name && a.enabled == b.enabled &&
+			a.inputRect == b.inputRect && a.bezierEnabled == b.bezierEnabled &&
+			a.softEdgeEnabled == b.softEdgeEnabled && a.softEdgePower == b.softEdgePower &&
+			a.softEdgeLuminance == b.softEdgeLuminance && a.softEdgeGamma == b.softEdgeGamma &&
+			a.controlWidth == b.controlWidth && a.controlHeight == b.controlHeight && a.vertices == b.vertices;
+	}
+
+	inline bool operator==(const MaskData & a, const MaskData & b) {
+		return a.uniqueId == b.uniqueId && a.name == b.name && a.enabled == b.enabled &&
+			a.closed == b.closed && a.inverted == b.inverted && a.feather == b.feather && a.points == b.points;
+	}
+
+	// Screen settings only, not its slices and masks
+	inline bool isScreenEqual(const ScreenData & a, const ScreenData & b) {
+		return a.uniqueId == b.uniqueId && a.name == b.name && a.enabled == b.enabled &&
+			a.width == b.width && a.height == b.height;
+	}
+
+	// Time spent in each phase of the last load, in seconds
+	struct LoadStats {
+		float parse = 0;
+		float construct = 0;
+		float build = 0;
+		size_t numScreens = 0;
+		size_t numSlices = 0;
+		size_t numMasks = 0;
+		// Read from the binary cache instead of the XML
+		bool cached = false;
+	};
+}
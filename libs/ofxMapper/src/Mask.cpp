@@ -1,13 +1,13 @@
 #include "Mask.h"
+#include "Profiler.h"
 
 using namespace ofxMapper;
 
-ofTessellator tessellator;
-
 Mask::Mask() {
-	uniqueId = ofToString((uint64_t)ofRandom(9999999999999));
+	uniqueId = UniqueId::create();
     closed.addListener(this, &Mask::closedChanged);
     inverted.addListener(this, &Mask::invertedChanged);
+    feather.addListener(this, &Mask::featherChanged);
     poly.resize(2);
 }
 
@@ -18,6 +18,7 @@ void Mask::setPoints(vector<glm::vec2> &points) {
 		h.position = p;
 		handles.push_back(h);
     }
+	invalidateHandleIndex();
 	update();
 }
 
@@ -25,7 +26,9 @@ void ofxMapper::Mask::addPoint(const glm::vec2 & p) {
 	DragHandle h;
 	h.position = p;
 	handles.push_back(h);
+	invalidateHandleIndex();
 	poly[0].addVertex(glm::vec3(h.position, 0));
+	revision++;
 }
 
 void ofxMapper::Mask::insertPoint(const glm::vec2 & p) {
@@ -67,6 +70,7 @@ void ofxMapper::Mask::insertPoint(const glm::vec2 & p) {
 		ofLog() << "After index: " << firstIndex;
 	}
 
+	invalidateHandleIndex();
 	update();
 }
 
@@ -74,7 +78,9 @@ void ofxMapper::Mask::setPoint(const glm::vec2 & p, int index) {
 	if (index < 0)
 		index = handles.size() - 1;
 	handles[index].position = p;
+	invalidateHandleIndex();
 	poly[0].getVertices().back() = glm::vec3(p, 0);
+	revision++;
 }
 
 void ofxMapper::Mask::removePoint(int index) {
@@ -82,10 +88,46 @@ void ofxMapper::Mask::removePoint(int index) {
 		index = handles.size() - 1;
 	if (index >= 0 && index < handles.size()) {
 		handles.erase(handles.begin() + index);
+		invalidateHandleIndex();
 		update();
 	}
 }
 
+void Mask::set(const MaskData & data, const ofRectangle & rect) {
+	if (data.uniqueId.isValid())
+		uniqueId = data.uniqueId;
+	name = data.name;
+	enabled = data.enabled;
+	closed.setWithoutEventNotifications(data.closed);
+	inverted.setWithoutEventNotifications(data.inverted);
+	feather.setWithoutEventNotifications(data.feather);
+
+	handles.clear();
+	for (auto & p : data.points) {
+		DragHandle h;
+		h.position = p;
+		handles.push_back(h);
+	}
+	invalidateHandleIndex();
+
+	screenRect = rect;
+	updateScreenContour();
+	poly[0].setClosed(closed);
+	geometryDirty = true;
+}
+
+void Mask::get(MaskData & data) {
+	data.uniqueId = uniqueId;
+	data.name = name;
+	data.enabled = enabled;
+	data.closed = closed;
+	data.inverted = inverted;
+	data.feather = feather;
+	data.points.clear();
+	for (auto & h : handles)
+		data.points.push_back(h.position);
+}
+
 void Mask::setScreenRect(const ofRectangle &rect) {
     this->screenRect = rect;
 	inverted.set(inverted);
@@ -98,15 +140,87 @@ void Mask::update() {
 	}
     if (closed)
         poly[0].close();
+    geometryDirty = false;
     updateMesh();
 }
 
+void Mask::flush() {
+    if (geometryDirty)
+        update();
+}
+
+bool Mask::isDirty() const {
+    return geometryDirty;
+}
+
+unsigned int Mask::getRebuildCount() const {
+    return rebuildCount;
+}
+
+MemoryUsage Mask::getMemoryUsage() const {
+	MemoryUsage usage;
+	usage.cpu[MEMORY_CURVES] += getCapacityBytes(poly) + getCapacityBytes(contour) + getCapacityBytes(screenContour);
+	for (auto & p : poly) {
+		usage.cpu[MEMORY_CURVES] += getCapacityBytes(p);
+	}
+	usage.cpu[MEMORY_MESHES] += getCapacityBytes(mesh);
+	usage.cpu[MEMORY_HANDLES] += getHandleMemoryUsage();
+	usage.cpu[MEMORY_SCRATCH] += triangulator.getMemoryUsage();
+	return usage;
+}
+
+void Mask::compact() {
+	poly.shrink_to_fit();
+	for (auto & p : poly) {
+		shrinkToFit(p);
+	}
+	contour.shrink_to_fit();
+	screenContour.shrink_to_fit();
+	shrinkToFit(mesh);
+	compactHandles();
+	triangulator.compact();
+}
+
 void Mask::updateMesh() {
+	TraceScope trace("Mask::updateMesh", "geometry");
     if (closed) {
-        tessellator.tessellateToMesh(poly, OF_POLY_WINDING_ODD, mesh);
+		contour.clear();
+		for (auto & v : poly[0].getVertices())
+			contour.push_back(glm::vec2(v));
+		screenContour.clear();
+		for (auto & v : poly[1].getVertices())
+			screenContour.push_back(glm::vec2(v));
+
+		// Inverted masks cut the mask out of the screen rect
+		bool simple = screenContour.empty() ?
+			triangulator.triangulate(contour) :
+			triangulator.triangulate(screenContour, &contour);
+
+		if (simple) {
+			mesh.clear();
+			mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+			for (auto & v : triangulator.getVertices())
+				mesh.addVertex(glm::vec3(v, 0));
+			mesh.addIndices(triangulator.getIndices());
+		}
+		else {
+			// Self-intersecting, let libtess sort it out
+			tessellator.tessellateToMesh(poly, OF_POLY_WINDING_ODD, mesh);
+		}
     }
     else
         mesh.clear();
+    revision++;
+    rebuildCount++;
+    Profiler::count(COUNTER_REBUILDS);
+}
+
+const vector<ofPolyline> & Mask::getPolylines() const {
+    return poly;
+}
+
+unsigned int Mask::getRevision() const {
+    return revision;
 }
 
 void Mask::draw() {
@@ -124,8 +238,16 @@ glm::vec2 Mask::getCenter() {
 	return poly[0].getCentroid2D();
 }
 
+const ofRectangle & Mask::getBounds() {
+    if (boundsRevision != revision) {
+        bounds = poly[0].getBoundingBox();
+        boundsRevision = revision;
+    }
+    return bounds;
+}
+
 bool Mask::select(const glm::vec2 &p) {
-    selected = poly[0].inside(p.x, p.y);
+    selected = getBounds().inside(p.x, p.y) && poly[0].inside(p.x, p.y);
     return selected;
 }
 
@@ -133,7 +255,8 @@ void Mask::move(const glm::vec2 & delta) {
 	for (DragHandle & h : handles) {
 		h.position += delta;
 	}
-	update();
+	invalidateHandleIndex();
+	geometryDirty = true;
 }
 
 bool Mask::removeHandleSelected() {
@@ -147,8 +270,10 @@ bool Mask::removeHandleSelected() {
 		else
 			++it;
 	}
-	if (removed)
+	if (removed) {
+		invalidateHandleIndex();
 		update();
+	}
 	return removed;
 }
 
@@ -157,7 +282,7 @@ void Mask::moveHandle(DragHandle & handle, const glm::vec2 & delta) {
 }
 
 void Mask::notifyHandles() {
-	update();
+	geometryDirty = true;
 }
 
 void Mask::closedChanged(bool &) {
@@ -166,6 +291,11 @@ void Mask::closedChanged(bool &) {
 }
 
 void Mask::invertedChanged(bool &) {
+    updateScreenContour();
+    updateMesh();
+}
+
+void Mask::updateScreenContour() {
     poly[1].clear();
     if (inverted && screenRect.getArea() > 0) {
         poly[1].addVertex(screenRect.getTopLeft());
@@ -173,5 +303,8 @@ void Mask::invertedChanged(bool &) {
         poly[1].addVertex(screenRect.getBottomRight());
         poly[1].addVertex(screenRect.getBottomLeft());
     }
-    updateMesh();
+}
+
+void Mask::featherChanged(float &) {
+    revision++;
 }
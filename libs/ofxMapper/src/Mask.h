@@ -3,6 +3,9 @@
 #include "ofMain.h"
 #include "Element.h"
 #include "DragHandle.h"
+#include "PolygonTriangulator.h"
+#include "MapperData.h"
+#include "MemoryUsage.h"
 
 namespace ofxMapper {
 
@@ -11,6 +14,10 @@ namespace ofxMapper {
 		Mask();
 
 		void setScreenRect(const ofRectangle & rect);
+		// Take all settings and points from data, the mesh is built by the next flush()
+		void set(const MaskData & data, const ofRectangle & screenRect);
+		// Copy all settings and points out
+		void get(MaskData & data);
 		void setPoints(vector<glm::vec2> & points);
 		void addPoint(const glm::vec2 & p);
 		void insertPoint(const glm::vec2 & p);
@@ -19,11 +26,27 @@ namespace ofxMapper {
 
 		void update();
 		void updateMesh();
+		// Rebuild the outline and mesh if drags or moves marked them dirty
+		void flush();
+		bool isDirty() const;
+		// Number of mesh rebuilds since creation
+		unsigned int getRebuildCount() const;
+
+		// Bytes held by the outline, mesh, handles and triangulator
+		MemoryUsage getMemoryUsage() const;
+		// Shrink buffers to fit and release the triangulator's scratch, keeping the mesh
+		void compact();
+
+		const vector<ofPolyline> & getPolylines() const;
+		// Incremented whenever the mask shape changes
+		unsigned int getRevision() const;
 
 		virtual void draw();
 		virtual void drawOutline();
 
 		virtual glm::vec2 getCenter();
+		// Bounds of the outline, which runs through all handles
+		const ofRectangle & getBounds();
 
 		virtual bool select(const glm::vec2 & p);
 		virtual void move(const glm::vec2 & delta);
@@ -36,17 +59,33 @@ namespace ofxMapper {
 
 		ofParameter<bool> closed = { "Closed", true };
 		ofParameter<bool> inverted = { "Inverted", false };
-		ofParameterGroup group = { "Mask" , name, enabled, editEnabled, closed, inverted, remove };
+		// Soft edge width in screen pixels, closed masks only
+		ofParameter<float> feather = { "Feather", 0, 0, 200 };
+		ofParameterGroup group = { "Mask" , name, enabled, editEnabled, closed, inverted, feather, remove };
 
 		//ofParameter<bool> selected = { "Selected", false };
 
 		void closedChanged(bool&);
 		void invertedChanged(bool&);
+		void featherChanged(float&);
 
 	private:
+		void updateScreenContour();
+
 		ofRectangle screenRect;
 		vector<ofPolyline> poly;
 		ofMesh mesh;
+		unsigned int revision = 0;
+		bool geometryDirty = false;
+		unsigned int rebuildCount = 0;
+		ofRectangle bounds;
+		unsigned int boundsRevision = -1;
+
+		// Per mask, so meshes can be rebuilt without sharing tessellator state
+		PolygonTriangulator triangulator;
+		ofTessellator tessellator;
+		vector<glm::vec2> contour;
+		vector<glm::vec2> screenContour;
 	};
 
 	typedef shared_ptr<Mask> MaskPtr;
@@ -0,0 +1,100 @@
+#include "MemoryUsage.h"
+
+using namespace ofxMapper;
+
+//--------------------------------------------------------------
+const char * ofxMapper::getMemoryCategoryName(MemoryCategory category) {
+	static const char * names[NUM_MEMORY_CATEGORIES] = {
+		"curves", "meshes", "handles", "fbos", "textures", "scratch"
+	};
+	return category < NUM_MEMORY_CATEGORIES ? names[category] : "";
+}
+
+//--------------------------------------------------------------
+size_t MemoryUsage::getCpuBytes() const {
+	size_t n = 0;
+	for (int i = 0; i < NUM_MEMORY_CATEGORIES; i++) {
+		n += cpu[i];
+	}
+	return n;
+}
+
+//--------------------------------------------------------------
+size_t MemoryUsage::getGpuBytes() const {
+	size_t n = 0;
+	for (int i = 0; i < NUM_MEMORY_CATEGORIES; i++) {
+		n += gpu[i];
+	}
+	return n;
+}
+
+//--------------------------------------------------------------
+MemoryUsage & MemoryUsage::operator+=(const MemoryUsage & usage) {
+	for (int i = 0; i < NUM_MEMORY_CATEGORIES; i++) {
+		cpu[i] += usage.cpu[i];
+		gpu[i] += usage.gpu[i];
+	}
+	return *this;
+}
+
+//--------------------------------------------------------------
+string MemoryUsage::toString() const {
+	string s;
+	char line[128];
+	snprintf(line, sizeof(line), "%-10s %10s %10s  (KB)\n", "category", "cpu", "gpu");
+	s += line;
+	for (int i = 0; i < NUM_MEMORY_CATEGORIES; i++) {
+		snprintf(line, sizeof(line), "%-10s %10.1f %10.1f\n", getMemoryCategoryName((MemoryCategory)i), cpu[i] / 1024.f, gpu[i] / 1024.f);
+		s += line;
+	}
+	snprintf(line, sizeof(line), "%-10s %10.1f %10.1f", "total", getCpuBytes() / 1024.f, getGpuBytes() / 1024.f);
+	s += line;
+	return s;
+}
+
+//--------------------------------------------------------------
+size_t ofxMapper::getCapacityBytes(const ofMesh & mesh) {
+	return getCapacityBytes(mesh.getVertices()) + getCapacityBytes(mesh.getNormals()) + getCapacityBytes(mesh.getColors())
+		+ getCapacityBytes(mesh.getTexCoords()) + getCapacityBytes(mesh.getIndices());
+}
+
+//--------------------------------------------------------------
+size_t ofxMapper::getCapacityBytes(const ofPolyline & polyline) {
+	return getCapacityBytes(polyline.getVertices());
+}
+
+//--------------------------------------------------------------
+size_t ofxMapper::getGpuBytes(const ofTexture & texture) {
+	if (!texture.isAllocated())
+		return 0;
+	const ofTextureData & data = texture.getTextureData();
+	int format = data.glInternalFormat;
+	size_t bytesPerPixel = ofGetNumChannelsFromGLFormat(ofGetGLFormatFromInternal(format)) * ofGetBytesPerChannelFromGLType(ofGetGLTypeFromInternal(format));
+	return (size_t)data.tex_w * (size_t)data.tex_h * bytesPerPixel;
+}
+
+//--------------------------------------------------------------
+size_t ofxMapper::getGpuBytes(const ofFbo & fbo, int samples) {
+	if (!fbo.isAllocated())
+		return 0;
+	size_t n = 0;
+	for (int i = 0; i < fbo.getNumTextures(); i++) {
+		n += getGpuBytes(fbo.getTexture(i));
+	}
+	// Multisampled buffers are resolved into the textures
+	return n * (samples > 0 ? samples + 1 : 1);
+}
+
+//--------------------------------------------------------------
+void ofxMapper::shrinkToFit(ofMesh & mesh) {
+	mesh.getVertices().shrink_to_fit();
+	mesh.getNormals().shrink_to_fit();
+	mesh.getColors().shrink_to_fit();
+	mesh.getTexCoords().shrink_to_fit();
+	mesh.getIndices().shrink_to_fit();
+}
+
+//--------------------------------------------------------------
+void ofxMapper::shrinkToFit(ofPolyline & polyline) {
+	polyline.getVertices().shrink_to_fit();
+}
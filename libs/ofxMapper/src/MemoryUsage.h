@@ -0,0 +1,52 @@
+#pragma once
+
+#include "ofMain.h"
+
+namespace ofxMapper {
+
+	enum MemoryCategory {
+		// Bezier curves and their sub-curves, control vertices, mask outlines
+		MEMORY_CURVES,
+		// Triangle meshes, warper outlines and patch vertex attributes
+		MEMORY_MESHES,
+		// Drag handles and their spatial index
+		MEMORY_HANDLES,
+		MEMORY_FBOS,
+		// Mask coverage and color and blend luts
+		MEMORY_TEXTURES,
+		// Buffers kept between rebuilds, e.g. rasterizer and triangulator state
+		MEMORY_SCRATCH,
+		NUM_MEMORY_CATEGORIES
+	};
+
+	const char * getMemoryCategoryName(MemoryCategory category);
+
+	// Bytes allocated per category, counting capacity rather than size. GPU bytes are
+	// estimated from texture sizes and formats, drivers may pad or compress them.
+	struct MemoryUsage {
+		size_t cpu[NUM_MEMORY_CATEGORIES] = {};
+		size_t gpu[NUM_MEMORY_CATEGORIES] = {};
+
+		size_t getCpuBytes() const;
+		size_t getGpuBytes() const;
+
+		MemoryUsage & operator+=(const MemoryUsage & usage);
+
+		// Table of categories in KB for logs
+		string toString() const;
+	};
+
+	template<typename T>
+	size_t getCapacityBytes(const vector<T> & v) {
+		return v.capacity() * sizeof(T);
+	}
+	size_t getCapacityBytes(const ofMesh & mesh);
+	size_t getCapacityBytes(const ofPolyline & polyline);
+
+	size_t getGpuBytes(const ofTexture & texture);
+	// Color textures, plus the multisampled buffer if samples is set
+	size_t getGpuBytes(const ofFbo & fbo, int samples = 0);
+
+	void shrinkToFit(ofMesh & mesh);
+	void shrinkToFit(ofPolyline & polyline);
+}
@@ -0,0 +1,480 @@
+#include "PolygonTriangulator.h"
+#include <algorithm>
+#include <limits>
+
+//--------------------------------------------------------------
+static inline float area(const glm::vec2 & p, const glm::vec2 & q, const glm::vec2 & r) {
+	return (q.y - p.y) * (r.x - q.x) - (q.x - p.x) * (r.y - q.y);
+}
+
+//--------------------------------------------------------------
+static inline float signedArea(const std::vector<glm::vec2> & v, size_t start, size_t end) {
+	float sum = 0;
+	for (size_t i = start, j = end - 1; i < end; j = i++) {
+		sum += (v[j].x - v[i].x) * (v[i].y + v[j].y);
+	}
+	return sum;
+}
+
+//--------------------------------------------------------------
+static inline bool pointInTriangle(float ax, float ay, float bx, float by, float cx, float cy, float px, float py) {
+	return (cx - px) * (ay - py) - (ax - px) * (cy - py) >= 0 &&
+		(ax - px) * (by - py) - (bx - px) * (ay - py) >= 0 &&
+		(bx - px) * (cy - py) - (cx - px) * (by - py) >= 0;
+}
+
+//--------------------------------------------------------------
+static inline bool onSegment(const glm::vec2 & p, const glm::vec2 & q, const glm::vec2 & r) {
+	return q.x <= std::max(p.x, r.x) && q.x >= std::min(p.x, r.x) && q.y <= std::max(p.y, r.y) && q.y >= std::min(p.y, r.y);
+}
+
+//--------------------------------------------------------------
+static inline int sign(float v) {
+	return v > 0 ? 1 : v < 0 ? -1 : 0;
+}
+
+//--------------------------------------------------------------
+static bool intersects(const glm::vec2 & p1, const glm::vec2 & q1, const glm::vec2 & p2, const glm::vec2 & q2) {
+	int o1 = sign(area(p1, q1, p2));
+	int o2 = sign(area(p1, q1, q2));
+	int o3 = sign(area(p2, q2, p1));
+	int o4 = sign(area(p2, q2, q1));
+
+	if (o1 != o2 && o3 != o4)
+		return true;
+	if (o1 == 0 && onSegment(p1, p2, q1))
+		return true;
+	if (o2 == 0 && onSegment(p1, q2, q1))
+		return true;
+	if (o3 == 0 && onSegment(p2, p1, q2))
+		return true;
+	if (o4 == 0 && onSegment(p2, q1, q2))
+		return true;
+	return false;
+}
+
+//--------------------------------------------------------------
+bool PolygonTriangulator::isSimple(const std::vector<glm::vec2> & outer, const std::vector<glm::vec2> * hole) {
+
+	// Sort and sweep along x, only testing segments with overlapping x ranges
+	std::vector<Segment> segments;
+	const std::vector<glm::vec2> * contours[2] = { &outer, hole };
+	for (int c = 0; c < 2; c++) {
+		if (!contours[c])
+			continue;
+		const std::vector<glm::vec2> & v = *contours[c];
+		size_t n = v.size();
+		for (size_t i = 0; i < n; i++) {
+			Segment s;
+			s.a = v[i];
+			s.b = v[(i + 1) % n];
+			s.minX = std::min(s.a.x, s.b.x);
+			s.maxX = std::max(s.a.x, s.b.x);
+			s.contour = c;
+			s.index = i;
+			s.count = n;
+			segments.push_back(s);
+		}
+	}
+	std::sort(segments.begin(), segments.end(), [](const Segment & a, const Segment & b) {
+		return a.minX < b.minX;
+	});
+
+	std::vector<const Segment *> active;
+	for (const Segment & s : segments) {
+		active.erase(std::remove_if(active.begin(), active.end(), [&s](const Segment * a) {
+			return a->maxX < s.minX;
+		}), active.end());
+
+		for (const Segment * a : active) {
+			if (a->contour == s.contour) {
+				bool adjacent = (a->index + 1) % s.count == s.index || (s.index + 1) % s.count == a->index;
+				if (adjacent) {
+					// Neighbours only share their common end point, unless they fold back
+					if (s.count > 2 && area(a->a, a->b, (a->b == s.a) ? s.b : s.a) == 0 && a->a != a->b) {
+						const glm::vec2 & other = (a->b == s.a) ? s.b : s.a;
+						const glm::vec2 & shared = (a->b == s.a) ? s.a : s.b;
+						const glm::vec2 & far = (a->b == s.a) ? a->a : a->b;
+						if (glm::dot(other - shared, far - shared) > 0)
+							return false;
+					}
+					continue;
+				}
+			}
+			if (intersects(a->a, a->b, s.a, s.b))
+				return false;
+		}
+		active.push_back(&s);
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+bool PolygonTriangulator::triangulate(const std::vector<glm::vec2> & outer, const std::vector<glm::vec2> * hole) {
+
+	indices.clear();
+	vertices.clear();
+
+	if (hole && hole->size() < 3)
+		hole = NULL;
+	if (outer.size() < 3)
+		return false;
+
+	if (!isSimple(outer, hole))
+		return false;
+
+	vertices.insert(vertices.end(), outer.begin(), outer.end());
+	if (hole)
+		vertices.insert(vertices.end(), hole->begin(), hole->end());
+
+	// Room for all vertices, two bridge duplicates and a steiner point pair.
+	// Node pointers must stay valid, so nodes are never reallocated after this.
+	nodes.clear();
+	nodes.reserve(vertices.size() + 4);
+
+	Node * outerNode = linkedList(0, outer.size(), true);
+	if (!outerNode || outerNode->next == outerNode->prev)
+		return false;
+
+	if (hole) {
+		Node * holeNode = linkedList(outer.size(), vertices.size(), false);
+		if (!holeNode)
+			return false;
+		outerNode = eliminateHole(holeNode, outerNode);
+		if (!outerNode)
+			return false;
+	}
+
+	// Only index large polygons, where z-order lookups beat scanning the ring
+	hashed = vertices.size() > 80;
+	if (hashed) {
+		minX = minY = std::numeric_limits<float>::max();
+		float maxX = std::numeric_limits<float>::lowest();
+		float maxY = std::numeric_limits<float>::lowest();
+		for (const glm::vec2 & v : vertices) {
+			minX = std::min(minX, v.x);
+			minY = std::min(minY, v.y);
+			maxX = std::max(maxX, v.x);
+			maxY = std::max(maxY, v.y);
+		}
+		invSize = std::max(maxX - minX, maxY - minY);
+		invSize = invSize != 0 ? 32767.f / invSize : 0;
+	}
+
+	indices.reserve((vertices.size() + 2) * 3);
+	return earcutLinked(outerNode, 0);
+}
+
+//--------------------------------------------------------------
+PolygonTriangulator::Node * PolygonTriangulator::insertNode(unsigned int i, float x, float y, Node * last) {
+	nodes.push_back({ i, x, y, 0, false, NULL, NULL, NULL, NULL });
+	Node * p = &nodes.back();
+	if (!last) {
+		p->prev = p;
+		p->next = p;
+	}
+	else {
+		p->next = last->next;
+		p->prev = last;
+		last->next->prev = p;
+		last->next = p;
+	}
+	return p;
+}
+
+//--------------------------------------------------------------
+PolygonTriangulator::Node * PolygonTriangulator::linkedList(size_t start, size_t end, bool clockwise) {
+	Node * last = NULL;
+	if (clockwise == (signedArea(vertices, start, end) > 0)) {
+		for (size_t i = start; i < end; i++)
+			last = insertNode(i, vertices[i].x, vertices[i].y, last);
+	}
+	else {
+		for (size_t i = end; i-- > start; )
+			last = insertNode(i, vertices[i].x, vertices[i].y, last);
+	}
+	if (last && last->x == last->next->x && last->y == last->next->y) {
+		Node * next = last->next;
+		removeNode(last);
+		last = next;
+	}
+	return last;
+}
+
+//--------------------------------------------------------------
+PolygonTriangulator::Node * PolygonTriangulator::eliminateHole(Node * hole, Node * outerNode) {
+
+	// Leftmost hole vertex
+	Node * m = hole;
+	Node * p = hole;
+	do {
+		if (p->x < m->x || (p->x == m->x && p->y < m->y))
+			m = p;
+		p = p->next;
+	} while (p != hole);
+
+	// Cast a ray to the left and find the closest outer edge. Nothing
+	// can be in between, so the bridge is always visible.
+	float hx = m->x;
+	float hy = m->y;
+	float qx = std::numeric_limits<float>::lowest();
+	Node * edge = NULL;
+	p = outerNode;
+	do {
+		Node * n = p->next;
+		if ((hy <= p->y && hy >= n->y) || (hy >= p->y && hy <= n->y)) {
+			if (p->y != n->y) {
+				float x = p->x + (hy - p->y) * (n->x - p->x) / (n->y - p->y);
+				if (x <= hx && x > qx) {
+					qx = x;
+					edge = p;
+				}
+			}
+		}
+		p = n;
+	} while (p != outerNode);
+
+	if (!edge)
+		return NULL;
+
+	// Bridge from an existing vertex if the ray hits one, else insert a point on the edge
+	Node * bridge;
+	if (edge->x == qx && edge->y == hy) {
+		bridge = edge;
+	}
+	else if (edge->next->x == qx && edge->next->y == hy) {
+		bridge = edge->next;
+	}
+	else {
+		vertices.push_back(glm::vec2(qx, hy));
+		bridge = insertNode(vertices.size() - 1, qx, hy, edge);
+		bridge->steiner = true;
+	}
+
+	Node * bridgeReverse = splitPolygon(bridge, m);
+	filterPoints(bridgeReverse, bridgeReverse->next);
+	return filterPoints(bridge, bridge->next);
+}
+
+//--------------------------------------------------------------
+PolygonTriangulator::Node * PolygonTriangulator::splitPolygon(Node * a, Node * b) {
+	Node * a2 = insertNode(a->i, a->x, a->y, NULL);
+	Node * b2 = insertNode(b->i, b->x, b->y, NULL);
+	a2->steiner = a->steiner;
+	b2->steiner = b->steiner;
+
+	Node * an = a->next;
+	Node * bp = b->prev;
+
+	a->next = b;
+	b->prev = a;
+
+	a2->next = an;
+	an->prev = a2;
+
+	b2->next = a2;
+	a2->prev = b2;
+
+	bp->next = b2;
+	b2->prev = bp;
+
+	return b2;
+}
+
+//--------------------------------------------------------------
+PolygonTriangulator::Node * PolygonTriangulator::filterPoints(Node * start, Node * end) {
+	if (!start)
+		return start;
+	if (!end)
+		end = start;
+
+	// Remove duplicate and collinear points
+	Node * p = start;
+	bool again;
+	do {
+		again = false;
+		bool equal = p->x == p->next->x && p->y == p->next->y;
+		if (!p->steiner && (equal || area(glm::vec2(p->prev->x, p->prev->y), glm::vec2(p->x, p->y), glm::vec2(p->next->x, p->next->y)) == 0)) {
+			removeNode(p);
+			p = end = p->prev;
+			if (p == p->next)
+				break;
+			again = true;
+		}
+		else {
+			p = p->next;
+		}
+	} while (again || p != end);
+
+	return end;
+}
+
+//--------------------------------------------------------------
+void PolygonTriangulator::removeNode(Node * p) {
+	p->next->prev = p->prev;
+	p->prev->next = p->next;
+	if (p->prevZ)
+		p->prevZ->nextZ = p->nextZ;
+	if (p->nextZ)
+		p->nextZ->prevZ = p->prevZ;
+}
+
+//--------------------------------------------------------------
+bool PolygonTriangulator::earcutLinked(Node * ear, int pass) {
+	if (!ear)
+		return false;
+
+	if (pass == 0 && hashed)
+		indexCurve(ear);
+
+	Node * stop = ear;
+
+	while (ear->prev != ear->next) {
+		Node * prev = ear->prev;
+		Node * next = ear->next;
+
+		if (hashed ? isEarHashed(ear) : isEar(ear)) {
+			indices.push_back(prev->i);
+			indices.push_back(ear->i);
+			indices.push_back(next->i);
+
+			removeNode(ear);
+
+			ear = next->next;
+			stop = next->next;
+			continue;
+		}
+
+		ear = next;
+
+		// A full loop without finding an ear
+		if (ear == stop) {
+			if (pass == 0)
+				return earcutLinked(filterPoints(ear), 1);
+			return false;
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+bool PolygonTriangulator::isEar(Node * ear) {
+	Node * a = ear->prev;
+	Node * b = ear;
+	Node * c = ear->next;
+
+	// Reflex, can't be an ear
+	if (area(glm::vec2(a->x, a->y), glm::vec2(b->x, b->y), glm::vec2(c->x, c->y)) >= 0)
+		return false;
+
+	// No other point may be inside the ear
+	Node * p = ear->next->next;
+	while (p != ear->prev) {
+		if (pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+			area(glm::vec2(p->prev->x, p->prev->y), glm::vec2(p->x, p->y), glm::vec2(p->next->x, p->next->y)) >= 0)
+			return false;
+		p = p->next;
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+bool PolygonTriangulator::isEarHashed(Node * ear) {
+	Node * a = ear->prev;
+	Node * b = ear;
+	Node * c = ear->next;
+
+	if (area(glm::vec2(a->x, a->y), glm::vec2(b->x, b->y), glm::vec2(c->x, c->y)) >= 0)
+		return false;
+
+	// Triangle bbox in z-order
+	float minTX = std::min(a->x, std::min(b->x, c->x));
+	float minTY = std::min(a->y, std::min(b->y, c->y));
+	float maxTX = std::max(a->x, std::max(b->x, c->x));
+	float maxTY = std::max(a->y, std::max(b->y, c->y));
+	uint32_t minZ = zOrder(minTX, minTY);
+	uint32_t maxZ = zOrder(maxTX, maxTY);
+
+	auto blocks = [&](Node * p) {
+		return p != a && p != c &&
+			pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+			area(glm::vec2(p->prev->x, p->prev->y), glm::vec2(p->x, p->y), glm::vec2(p->next->x, p->next->y)) >= 0;
+	};
+
+	// Look for points inside the triangle in both directions
+	Node * p = ear->prevZ;
+	Node * n = ear->nextZ;
+
+	while (p && p->z >= minZ && n && n->z <= maxZ) {
+		if (blocks(p))
+			return false;
+		p = p->prevZ;
+		if (blocks(n))
+			return false;
+		n = n->nextZ;
+	}
+	while (p && p->z >= minZ) {
+		if (blocks(p))
+			return false;
+		p = p->prevZ;
+	}
+	while (n && n->z <= maxZ) {
+		if (blocks(n))
+			return false;
+		n = n->nextZ;
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+void PolygonTriangulator::indexCurve(Node * start) {
+	zsorted.clear();
+	Node * p = start;
+	do {
+		p->z = zOrder(p->x, p->y);
+		zsorted.push_back(p);
+		p = p->next;
+	} while (p != start);
+
+	std::sort(zsorted.begin(), zsorted.end(), [](const Node * a, const Node * b) {
+		return a->z < b->z;
+	});
+
+	for (size_t i = 0; i < zsorted.size(); i++) {
+		zsorted[i]->prevZ = i > 0 ? zsorted[i - 1] : NULL;
+		zsorted[i]->nextZ = i + 1 < zsorted.size() ? zsorted[i + 1] : NULL;
+	}
+}
+
+//--------------------------------------------------------------
+uint32_t PolygonTriangulator::zOrder(float fx, float fy) {
+	// Coords are transformed into non-negative 15-bit integer range
+	uint32_t x = (uint32_t)((fx - minX) * invSize);
+	uint32_t y = (uint32_t)((fy - minY) * invSize);
+
+	x = (x | (x << 8)) & 0x00FF00FF;
+	x = (x | (x << 4)) & 0x0F0F0F0F;
+	x = (x | (x << 2)) & 0x33333333;
+	x = (x | (x << 1)) & 0x55555555;
+
+	y = (y | (y << 8)) & 0x00FF00FF;
+	y = (y | (y << 4)) & 0x0F0F0F0F;
+	y = (y | (y << 2)) & 0x33333333;
+	y = (y | (y << 1)) & 0x55555555;
+
+	return x | (y << 1);
+}
+
+//--------------------------------------------------------------
+size_t PolygonTriangulator::getMemoryUsage() const {
+	return nodes.capacity() * sizeof(Node) + zsorted.capacity() * sizeof(Node *)
+		+ vertices.capacity() * sizeof(glm::vec2) + indices.capacity() * sizeof(unsigned int);
+}
+
+//--------------------------------------------------------------
+void PolygonTriangulator::compact() {
+	std::vector<Node>().swap(nodes);
+	std::vector<Node *>().swap(zsorted);
+	vertices.shrink_to_fit();
+	indices.shrink_to_fit();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "glm/glm.hpp"
+
+// Ear-clipping triangulator for simple polygons with an optional hole.
+// Ear tests are accelerated by a z-order curve index, similar to mapbox earcut.
+// Scratch buffers are kept between calls, so keep one instance per polygon being edited.
+class PolygonTriangulator {
+public:
+	// Triangulate outer, minus hole if not NULL. Returns false if the input
+	// is self-intersecting or degenerate, in which case the output is undefined.
+	bool triangulate(const std::vector<glm::vec2> & outer, const std::vector<glm::vec2> * hole = NULL);
+
+	// Outer vertices, followed by hole vertices and any inserted bridge point
+	const std::vector<glm::vec2> & getVertices() const { return vertices; }
+	const std::vector<unsigned int> & getIndices() const { return indices; }
+
+	static bool isSimple(const std::vector<glm::vec2> & outer, const std::vector<glm::vec2> * hole = NULL);
+
+	// Heap bytes of the output and scratch buffers, by capacity
+	size_t getMemoryUsage() const;
+	// Release the scratch buffers and excess output capacity, the output is kept
+	void compact();
+
+private:
+	struct Node {
+		unsigned int i;
+		float x;
+		float y;
+		uint32_t z;
+		bool steiner;
+		Node * prev;
+		Node * next;
+		Node * prevZ;
+		Node * nextZ;
+	};
+
+	Node * insertNode(unsigned int i, float x, float y, Node * last);
+	Node * linkedList(size_t start, size_t end, bool clockwise);
+	Node * eliminateHole(Node * hole, Node * outerNode);
+	Node * filterPoints(Node * start, Node * end = NULL);
+	void removeNode(Node * p);
+	Node * splitPolygon(Node * a, Node * b);
+	bool earcutLinked(Node * ear, int pass);
+	bool isEar(Node * ear);
+	bool isEarHashed(Node * ear);
+	void indexCurve(Node * start);
+	uint32_t zOrder(float x, float y);
+
+	std::vector<Node> nodes;
+	std::vector<Node *> zsorted;
+	std::vector<glm::vec2> vertices;
+	std::vector<unsigned int> indices;
+
+	float minX, minY, invSize;
+	bool hashed;
+
+	struct Segment {
+		glm::vec2 a;
+		glm::vec2 b;
+		float minX;
+		float maxX;
+		int contour;
+		size_t index;
+		size_t count;
+	};
+};
@@ -0,0 +1,102 @@
+#include "Profiler.h"
+
+using namespace ofxMapper;
+
+std::atomic<bool> Profiler::enabled(false);
+std::atomic<uint64_t> Profiler::times[NUM_STAGES];
+std::atomic<uint64_t> Profiler::counters[NUM_COUNTERS];
+FrameStats Profiler::stats;
+vector<float> Profiler::history[NUM_STAGES];
+size_t Profiler::historyIndex = 0;
+
+//--------------------------------------------------------------
+const char * ofxMapper::getStageName(ProfileStage stage) {
+	static const char * names[NUM_STAGES] = {
+		"update", "flush", "blend rects", "screen update", "slice draw", "mask update", "mask draw", "draw"
+	};
+	return stage < NUM_STAGES ? names[stage] : "";
+}
+
+//--------------------------------------------------------------
+const char * ofxMapper::getCounterName(ProfileCounter counter) {
+	static const char * names[NUM_COUNTERS] = {
+		"draw calls", "vertices", "triangles", "rebuilds", "uniforms", "allocations"
+	};
+	return counter < NUM_COUNTERS ? names[counter] : "";
+}
+
+//--------------------------------------------------------------
+string FrameStats::toString() const {
+	string s;
+	char line[128];
+	snprintf(line, sizeof(line), "%-14s %8s %8s %8s %8s  (ms over %zu frames)\n", "stage", "last", "min", "avg", "p99", (size_t)std::min<uint64_t>(numFrames, Profiler::window));
+	s += line;
+	for (int i = 0; i < NUM_STAGES; i++) {
+		const StageStats & st = stages[i];
+		snprintf(line, sizeof(line), "%-14s %8.3f %8.3f %8.3f %8.3f\n", getStageName((ProfileStage)i), st.last, st.min, st.avg, st.p99);
+		s += line;
+	}
+	for (int i = 0; i < NUM_COUNTERS; i++) {
+		snprintf(line, sizeof(line), "%s%s %llu", i ? ", " : "", getCounterName((ProfileCounter)i), (unsigned long long)counters[i]);
+		s += line;
+	}
+	return s;
+}
+
+//--------------------------------------------------------------
+void Profiler::setEnabled(bool enabled) {
+	if (enabled && !isEnabled())
+		reset();
+	Profiler::enabled = enabled;
+}
+
+//--------------------------------------------------------------
+void Profiler::endFrame() {
+
+	if (!isEnabled())
+		return;
+
+	for (int i = 0; i < NUM_COUNTERS; i++) {
+		stats.counters[i] = counters[i].exchange(0, std::memory_order_relaxed);
+	}
+
+	stats.numFrames++;
+	size_t n = std::min<uint64_t>(stats.numFrames, window);
+	vector<float> sorted;
+	for (int i = 0; i < NUM_STAGES; i++) {
+		float ms = times[i].exchange(0, std::memory_order_relaxed) / 1000000.f;
+		vector<float> & h = history[i];
+		h.resize(window);
+		h[historyIndex] = ms;
+
+		StageStats & st = stats.stages[i];
+		st.last = ms;
+		sorted.assign(h.begin(), h.begin() + n);
+		size_t p99 = std::min(n - 1, (size_t)(n * 0.99f));
+		std::nth_element(sorted.begin(), sorted.begin() + p99, sorted.end());
+		st.p99 = sorted[p99];
+		st.min = *std::min_element(sorted.begin(), sorted.end());
+		float sum = 0;
+		for (float t : sorted)
+			sum += t;
+		st.avg = sum / n;
+	}
+	historyIndex = (historyIndex + 1) % window;
+}
+
+//--------------------------------------------------------------
+const FrameStats & Profiler::getFrameStats() {
+	return stats;
+}
+
+//--------------------------------------------------------------
+void Profiler::reset() {
+	for (auto & t : times)
+		t = 0;
+	for (auto & c : counters)
+		c = 0;
+	for (auto & h : history)
+		h.clear();
+	historyIndex = 0;
+	stats = FrameStats();
+}
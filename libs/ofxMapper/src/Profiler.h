@@ -0,0 +1,122 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Tracer.h"
+#include <atomic>
+
+namespace ofxMapper {
+
+	// Timed stages of a frame. Stages nest, e.g. slice draws are part of screen updates.
+	enum ProfileStage {
+		STAGE_UPDATE,
+		STAGE_FLUSH,
+		STAGE_BLEND_RECTS,
+		STAGE_SCREEN_UPDATE,
+		STAGE_SLICE_DRAW,
+		STAGE_MASK_UPDATE,
+		STAGE_MASK_DRAW,
+		STAGE_DRAW,
+		NUM_STAGES
+	};
+
+	enum ProfileCounter {
+		COUNTER_DRAW_CALLS,
+		COUNTER_VERTICES,
+		COUNTER_TRIANGLES,
+		COUNTER_REBUILDS,
+		COUNTER_UNIFORMS,
+		COUNTER_ALLOCATIONS,
+		NUM_COUNTERS
+	};
+
+	// Milliseconds spent in a stage, summed over each frame
+	struct StageStats {
+		float last = 0;
+		float min = 0;
+		float avg = 0;
+		float p99 = 0;
+	};
+
+	struct FrameStats {
+		// Over the last frames, see Profiler::window
+		StageStats stages[NUM_STAGES];
+		// Last complete frame
+		uint64_t counters[NUM_COUNTERS] = {};
+		uint64_t numFrames = 0;
+
+		// Table of stages and counters for logs
+		string toString() const;
+	};
+
+	const char * getStageName(ProfileStage stage);
+	const char * getCounterName(ProfileCounter counter);
+
+	// Process wide stage timers and counters. While disabled, timers and counters only
+	// check a flag. Counters may be bumped from any thread.
+	class Profiler {
+	public:
+		static void setEnabled(bool enabled);
+		static bool isEnabled() {
+			return enabled.load(std::memory_order_relaxed);
+		}
+
+		static void addTime(ProfileStage stage, uint64_t nanoseconds) {
+			times[stage].fetch_add(nanoseconds, std::memory_order_relaxed);
+		}
+		static void count(ProfileCounter counter, uint64_t n = 1) {
+			if (isEnabled())
+				counters[counter].fetch_add(n, std::memory_order_relaxed);
+		}
+		// One draw call of a triangle mesh
+		static void countMesh(const ofMesh & mesh) {
+			if (!isEnabled())
+				return;
+			size_t n = mesh.getNumIndices() ? mesh.getNumIndices() : mesh.getNumVertices();
+			count(COUNTER_DRAW_CALLS);
+			count(COUNTER_VERTICES, mesh.getNumVertices());
+			count(COUNTER_TRIANGLES, n / 3);
+		}
+
+		// Close the current frame and fold it into the stats
+		static void endFrame();
+		static const FrameStats & getFrameStats();
+		static void reset();
+
+		// Frames the min, average and 99th percentile are taken over
+		static const size_t window = 240;
+
+	private:
+		static std::atomic<bool> enabled;
+		static std::atomic<uint64_t> times[NUM_STAGES];
+		static std::atomic<uint64_t> counters[NUM_COUNTERS];
+
+		static FrameStats stats;
+		static vector<float> history[NUM_STAGES];
+		static size_t historyIndex;
+	};
+
+	// Adds the time until the end of the scope to a stage if profiling is enabled, and
+	// records it as a trace event if tracing is
+	class ProfileScope {
+	public:
+		ProfileScope(ProfileStage stage) : stage(stage), profiling(Profiler::isEnabled()), tracing(Tracer::isEnabled()) {
+			if (profiling || tracing)
+				start = Tracer::now();
+		}
+		~ProfileScope() {
+			if (!profiling && !tracing)
+				return;
+			uint64_t end = Tracer::now();
+			if (profiling)
+				Profiler::addTime(stage, end - start);
+			if (tracing)
+				Tracer::record(getStageName(stage), "frame", start, end);
+		}
+
+	private:
+		ProfileStage stage;
+		bool profiling;
+		bool tracing;
+		uint64_t start = 0;
+	};
+}
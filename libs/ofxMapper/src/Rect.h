@@ -0,0 +1,45 @@
+#pragma once
+
+#include <utility>
+#include "glm/glm.hpp"
+
+namespace ofxMapper {
+
+	// Axis aligned rectangle for the model and file code, which builds without
+	// openFrameworks. Has the fields of ofRectangle and converts to and from it, or any
+	// other type with those fields, a getArea() and a (x, y, width, height) constructor.
+	struct Rect {
+		float x = 0;
+		float y = 0;
+		float width = 0;
+		float height = 0;
+
+		Rect() {}
+		Rect(float x, float y, float width, float height) : x(x), y(y), width(width), height(height) {}
+
+		template<typename R, typename = decltype(std::declval<const R &>().getArea())>
+		Rect(const R & r) : x(r.x), y(r.y), width(r.width), height(r.height) {}
+
+		template<typename R, typename = decltype(std::declval<const R &>().getArea()), typename = decltype(R(0.f, 0.f, 0.f, 0.f))>
+		operator R() const {
+			return R(x, y, width, height);
+		}
+
+		void set(float x, float y, float width, float height) {
+			this->x = x;
+			this->y = y;
+			this->width = width;
+			this->height = height;
+		}
+
+		glm::vec2 getPosition() const { return glm::vec2(x, y); }
+		glm::vec2 getSize() const { return glm::vec2(width, height); }
+
+		bool operator==(const Rect & r) const {
+			return x == r.x && y == r.y && width == r.width && height == r.height;
+		}
+		bool operator!=(const Rect & r) const {
+			return !(*this == r);
+		}
+	};
+}
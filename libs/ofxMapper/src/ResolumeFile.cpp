@@ -1,4 +1,11 @@
 #include "ResolumeFile.h"
+#include "VertexCodec.h"
+#include "Tracer.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
 
 ResolumeFile::ResolumeFile() {
 	if (!(state = xml.getChild("XmlState")))
@@ -6,22 +13,57 @@ ResolumeFile::ResolumeFile() {
 }
 
 bool ResolumeFile::load(string filePath) {
+	source.clear();
 	bool loaded = xml.load(filePath);
 	if (!(state = xml.getChild("XmlState")))
 		state = xml.appendChild("XmlState");
 	return loaded;
 }
 
-bool ResolumeFile::save(string filePath) {
-	return xml.save(filePath);
+void ResolumeFile::setSource(string source) {
+	this->source = std::move(source);
+}
+
+void ResolumeFile::parseSource() {
+	TraceScope trace("ResolumeFile::parseSource", "io");
+	if (source.empty())
+		return;
+	xml.parse(source);
+	if (!(state = xml.getChild("XmlState")))
+		state = xml.appendChild("XmlState");
+	source.clear();
+	source.shrink_to_fit();
+}
+
+bool ResolumeFile::save(string filePath, string * savedText) {
+	TraceScope trace("ResolumeFile::save", "io");
+	parseSource();
+	// Replace the file in one step so it is never left half written
+	string path = ofToDataPath(filePath);
+	string tmpPath = path + ".tmp";
+	if (!xml.save(tmpPath))
+		return false;
+	if (savedText)
+		*savedText = ofBufferFromFile(tmpPath).getText();
+#ifdef _WIN32
+	if (!MoveFileExA(tmpPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+#else
+	if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+#endif
+		remove(tmpPath.c_str());
+		return false;
+	}
+	return true;
 }
 
 bool ResolumeFile::isValid(string versionName) {
+	parseSource();
     string name = state.getChild("versionInfo").getAttribute("name").getValue();
 	return name == versionName;
 }
 
 void ResolumeFile::setVersion(string name) {
+	parseSource();
 	ofXml version;
 	if (!(version = state.getChild("versionInfo"))) {
 		version = state.appendChild("versionInfo");
@@ -30,6 +72,7 @@ void ResolumeFile::setVersion(string name) {
 }
 
 ofRectangle ResolumeFile::getCompositionSize() {
+	parseSource();
 	ofRectangle r;
 	ofXml comp = xml.findFirst("//CurrentCompositionTextureSize");
     r.width = comp.getAttribute("width").getIntValue();
@@ -38,6 +81,7 @@ ofRectangle ResolumeFile::getCompositionSize() {
 }
 
 void ResolumeFile::setCompositionSize(int width, int height) {
+	parseSource();
 	ofXml screenSetup;
 	if (!(screenSetup = state.getChild("ScreenSetup"))) {
 		screenSetup = state.appendChild("ScreenSetup");
@@ -51,28 +95,32 @@ void ResolumeFile::setCompositionSize(int width, int height) {
 }
 
 int ResolumeFile::loadScreens() {
+	parseSource();
     ofXml::Search search = xml.find("//Screen");
 	screens.clear();
+	screenIndex.clear();
     for (auto & s : search) {
         screens.push_back(s);
+		screenIndex[readUniqueId(s)] = s;
     }
 	return screens.size();
 }
 
 ResolumeFile::Screen ResolumeFile::getScreen(int screenIndex) {
+	parseSource();
 	return screens[screenIndex];
 }
 
-ResolumeFile::Screen ResolumeFile::getScreen(string uniqueId) {
-	for (auto & s : screens) {
-		if (s.getAttribute("uniqueId").getValue() == uniqueId) {
-			return s;
-		}
-	}
+ResolumeFile::Screen ResolumeFile::getScreen(const UniqueId & uniqueId) {
+	parseSource();
+	auto it = screenIndex.find(uniqueId);
+	if (it != screenIndex.end())
+		return it->second;
 	return addScreen(uniqueId);
 }
 
-ResolumeFile::Screen ResolumeFile::addScreen(string uniqueId) {
+ResolumeFile::Screen ResolumeFile::addScreen(const UniqueId & uniqueId) {
+	parseSource();
 	ofXml screenSetup;
 	if (!(screenSetup = state.getChild("ScreenSetup"))) {
 		screenSetup = state.appendChild("ScreenSetup");
@@ -82,30 +130,58 @@ ResolumeFile::Screen ResolumeFile::addScreen(string uniqueId) {
 		scrns = screenSetup.appendChild("screens");
 	}
 	ofXml scrn = scrns.appendChild("Screen");
-	scrn.setAttribute("uniqueId", uniqueId);
+	scrn.setAttribute("uniqueId", uniqueId.toString());
 	screens.push_back(scrn);
+	screenIndex[uniqueId] = scrn;
 
 	return Screen(scrn);
 }
 
-void ResolumeFile::removeScreen(string uniqueId) {
-	ofXml screen = xml.findFirst("//Screen[@uniqueId='" + uniqueId + "']");
-	if (!screen)
-		return;
+void ResolumeFile::removeScreen(const UniqueId & uniqueId) {
+	parseSource();
+	removeNode(screens, screenIndex, uniqueId);
+}
 
-	ofXml screenSetup;
-	if (!(screenSetup = state.getChild("ScreenSetup")))
-		return;
+void ResolumeFile::setVertices(ofXml & x, const string & tag, const glm::vec2 * vertices, size_t n) {
+	string text;
+	VertexCodec::encode(tag, vertices, n, text);
+	ofXml fragment;
+	fragment.parse(text);
+	x.removeChild(tag);
+	x.appendChild(fragment.getFirstChild());
+}
 
-	ofXml scrns;
-	if (!(scrns = screenSetup.getChild("screens")))
-		return;
+vector<glm::vec2> ResolumeFile::getVertices(const ofXml & x) {
+	vector<glm::vec2> vertices;
+	if (!x)
+		return vertices;
+	for (auto v : x.getChildren("v")) {
+		glm::vec2 p;
+		VertexCodec::parseFloat(v.getAttribute("x").getValue(), p.x);
+		VertexCodec::parseFloat(v.getAttribute("y").getValue(), p.y);
+		vertices.push_back(p);
+	}
+	return vertices;
+}
+
+UniqueId ResolumeFile::readUniqueId(const ofXml & x) {
+	return UniqueId::parse(x.getAttribute("uniqueId").getValue());
+}
 
-	scrns.removeChild(screen);
+void ResolumeFile::removeNode(vector<ofXml> & nodes, unordered_map<UniqueId, ofXml> & index, const UniqueId & uniqueId) {
+	auto it = index.find(uniqueId);
+	if (it == index.end())
+		return;
+	ofXml node = it->second;
+	index.erase(it);
+	nodes.erase(std::remove_if(nodes.begin(), nodes.end(), [&](const ofXml & n) {
+		return readUniqueId(n) == uniqueId;
+	}), nodes.end());
+	node.getParent().removeChild(node);
 }
 
-string ResolumeFile::Screen::getUniqueId() {
-	return xml.getAttribute("uniqueId").getValue();
+UniqueId ResolumeFile::Screen::getUniqueId() {
+	return readUniqueId(xml);
 }
 
 string ResolumeFile::Screen::getName() {
@@ -153,8 +229,11 @@ void ResolumeFile::Screen::setEnabled(bool enabled) {
 
 int ResolumeFile::Screen::loadSlices() {
     ofXml::Search search = xml.find("./layers/Slice");
+	slices.clear();
+	sliceIndex.clear();
     for (auto & s : search) {
         slices.push_back(s);
+		sliceIndex[readUniqueId(s)] = s;
     }
 	return slices.size();
 }
@@ -167,38 +246,31 @@ ResolumeFile::Slice ResolumeFile::Screen::getSlice(int sliceIndex) {
 	return slices[sliceIndex];
 }
 
-ResolumeFile::Slice ResolumeFile::Screen::getSlice(string uniqueId) {
-	for (auto & s : slices) {
-		if (s.getAttribute("uniqueId").getValue() == uniqueId)
-			return s;
-	}
+ResolumeFile::Slice ResolumeFile::Screen::getSlice(const UniqueId & uniqueId) {
+	auto it = sliceIndex.find(uniqueId);
+	if (it != sliceIndex.end())
+		return it->second;
 	return addSlice(uniqueId);
 }
 
-ResolumeFile::Slice ResolumeFile::Screen::addSlice(string uniqueId) {
+ResolumeFile::Slice ResolumeFile::Screen::addSlice(const UniqueId & uniqueId) {
 	ofXml layers;
 	if (!(layers = xml.getChild("layers"))) {
 		layers = xml.appendChild("layers");
 	}
 	ofXml slice = layers.appendChild("Slice");
-	slice.setAttribute("uniqueId", uniqueId);
+	slice.setAttribute("uniqueId", uniqueId.toString());
+	slices.push_back(slice);
+	sliceIndex[uniqueId] = slice;
 	return Slice(slice);
 }
 
-void ResolumeFile::Screen::removeSlice(string uniqueId) {
-	ofXml slice = xml.findFirst("./layers/Slice[@uniqueId='" + uniqueId + "']");
-	if (!slice)
-		return;
-
-	ofXml layers;
-	if (!(layers = xml.getChild("layers")))
-		return;
-
-	layers.removeChild(slice);
+void ResolumeFile::Screen::removeSlice(const UniqueId & uniqueId) {
+	ResolumeFile::removeNode(slices, sliceIndex, uniqueId);
 }
 
-string ResolumeFile::Slice::getUniqueId() {
-	return xml.getAttribute("uniqueId").getValue();
+UniqueId ResolumeFile::Slice::getUniqueId() {
+	return readUniqueId(xml);
 }
 
 string ResolumeFile::Slice::getName() {
@@ -289,15 +361,7 @@ void ResolumeFile::Slice::getWarperDim(int & width, int & height) {
 }
 
 vector<glm::vec2> ResolumeFile::Slice::getWarperVertices() {
-	vector<glm::vec2> vertices;
-	ofXml::Search vts = xml.find("./Warper/BezierWarper/vertices/v");
-	for (auto & v : vts) {
-		glm::vec2 p;
-		p.x = v.getAttribute("x").getFloatValue();
-		p.y = v.getAttribute("y").getFloatValue();
-		vertices.push_back(p);
-	}
-	return vertices;
+	return getVertices(xml.getChild("Warper").getChild("BezierWarper").getChild("vertices"));
 }
 
 void ResolumeFile::Slice::setWarperVertices(size_t controlWidth, size_t controlHeight, glm::vec2 * vertices) {
@@ -312,20 +376,16 @@ void ResolumeFile::Slice::setWarperVertices(size_t controlWidth, size_t controlH
 	bezier.setAttribute("controlWidth", controlWidth);
 	bezier.setAttribute("controlHeight", controlHeight);
 
-	bezier.removeChild("vertices");
-	ofXml vert = bezier.appendChild("vertices");
-
-	size_t n = controlWidth * controlHeight;
-	for (size_t i = 0; i < n; i++) {
-		ResolumeFile::addVertex(vert, vertices[i]);
-	}
+	ResolumeFile::setVertices(bezier, "vertices", vertices, controlWidth * controlHeight);
 }
 
 int ResolumeFile::Screen::loadMasks() {
     ofXml::Search search = xml.find("./layers/Mask");
 	masks.clear();
+	maskIndex.clear();
     for (auto & s : search) {
         masks.push_back(s);
+		maskIndex[readUniqueId(s)] = s;
     }
     return masks.size();
 }
@@ -338,39 +398,31 @@ ResolumeFile::Mask ResolumeFile::Screen::getMask(int maskIndex) {
     return masks[maskIndex];
 }
 
-ResolumeFile::Mask ResolumeFile::Screen::getMask(string uniqueId) {
-	for (auto & m : masks) {
-		if (m.getAttribute("uniqueId").getValue() == uniqueId)
-			return m;
-	}
+ResolumeFile::Mask ResolumeFile::Screen::getMask(const UniqueId & uniqueId) {
+	auto it = maskIndex.find(uniqueId);
+	if (it != maskIndex.end())
+		return it->second;
 	return addMask(uniqueId);
-
 }
 
-ResolumeFile::Mask ResolumeFile::Screen::addMask(string uniqueId) {
+ResolumeFile::Mask ResolumeFile::Screen::addMask(const UniqueId & uniqueId) {
 	ofXml layers;
 	if (!(layers = xml.getChild("layers"))) {
 		layers = xml.appendChild("layers");
 	}
 	ofXml mask = layers.appendChild("Mask");
-	mask.setAttribute("uniqueId", uniqueId);
+	mask.setAttribute("uniqueId", uniqueId.toString());
+	masks.push_back(mask);
+	maskIndex[uniqueId] = mask;
 	return Mask(mask);
 }
 
-void ResolumeFile::Screen::removeMask(string uniqueId) {
-	ofXml mask = xml.findFirst("./layers/Mask[@uniqueId='" + uniqueId + "']");
-	if (!mask)
-		return;
-
-	ofXml layers;
-	if (!(layers = xml.getChild("layers")))
-		return;
-
-	layers.removeChild(mask);
+void ResolumeFile::Screen::removeMask(const UniqueId & uniqueId) {
+	ResolumeFile::removeNode(masks, maskIndex, uniqueId);
 }
 
-string ResolumeFile::Mask::getUniqueId() {
-	return xml.getAttribute("uniqueId").getValue();
+UniqueId ResolumeFile::Mask::getUniqueId() {
+	return readUniqueId(xml);
 }
 
 string ResolumeFile::Mask::getName() {
@@ -397,20 +449,21 @@ void ResolumeFile::Mask::setInverted(bool inverted) {
 	ResolumeFile::setParam(xml, "Output", "Invert", inverted);
 }
 
+float ResolumeFile::Mask::getFeather(float feather) {
+	ofXml first = xml.findFirst("./Params/ParamRange[@name='Feather']");
+	return first ? first.getAttribute("value").getFloatValue() : feather;
+}
+
+void ResolumeFile::Mask::setFeather(float feather) {
+	ResolumeFile::setParamRange(xml, "Output", "Feather", feather);
+}
+
 bool ResolumeFile::Mask::getClosed() {
 	return xml.findFirst("./ShapeObject/Shape/Contour").getAttribute("closed").getBoolValue();
 }
 
 vector<glm::vec2> ResolumeFile::Mask::getPoints() {
-    vector<glm::vec2> points;
-    ofXml::Search pts = xml.find("./ShapeObject/Shape/Contour/points/v");
-    for (auto & v : pts) {
-        glm::vec2 p;
-        p.x = v.getAttribute("x").getFloatValue();
-        p.y = v.getAttribute("y").getFloatValue();
-        points.push_back(p);
-    }
-    return points;
+	return getVertices(xml.getChild("ShapeObject").getChild("Shape").getChild("Contour").getChild("points"));
 }
 
 void ResolumeFile::Mask::setPoints(const vector<glm::vec2>& pts, bool closed) {
@@ -427,10 +480,5 @@ void ResolumeFile::Mask::setPoints(const vector<glm::vec2>& pts, bool closed) {
 		contour = shape.appendChild("Contour");
 	}
 	contour.setAttribute("closed", closed);
-	contour.removeChild("points");
-
-	ofXml points = contour.appendChild("points");
-	for (const glm::vec2 & p : pts) {
-		ResolumeFile::addVertex(points, p);
-	}
+	ResolumeFile::setVertices(contour, "points", pts.data(), pts.size());
 }
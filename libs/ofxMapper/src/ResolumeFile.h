@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ofMain.h"
+#include "UniqueId.h"
 
 class ResolumeFile {
 public:
@@ -8,7 +9,10 @@ public:
 	ResolumeFile();
 
 	bool load(string filePath);
-	bool save(string filePath);
+	// Keep the text of an already read file, the DOM is only built when first needed
+	void setSource(string source);
+	// Written aside and renamed over filePath. savedText, if set, gets what was written.
+	bool save(string filePath, string * savedText = NULL);
 
 	bool isValid(string versionName);
 	void setVersion(string name);
@@ -23,9 +27,9 @@ public:
 	// Screens
 	int loadScreens();
 	Screen getScreen(int screenIndex);
-	Screen getScreen(string uniqueId);
-	Screen addScreen(string uniqueId);
-	void removeScreen(string uniqueId);
+	Screen getScreen(const UniqueId & uniqueId);
+	Screen addScreen(const UniqueId & uniqueId);
+	void removeScreen(const UniqueId & uniqueId);
 
 	class Screen {
 	public:
@@ -34,7 +38,7 @@ public:
 			loadMasks();
 		}
 
-		string getUniqueId();
+		UniqueId getUniqueId();
 
         string getName();
 		void setName(string name);
@@ -46,21 +50,23 @@ public:
         int loadSlices();
 		int getNumSlices();
 		Slice getSlice(int sliceIndex);
-		Slice getSlice(string uniqueId);
-		Slice addSlice(string uniqueId);
-		void removeSlice(string uniqueId);
+		Slice getSlice(const UniqueId & uniqueId);
+		Slice addSlice(const UniqueId & uniqueId);
+		void removeSlice(const UniqueId & uniqueId);
 
         int loadMasks();
 		int getNumMasks();
         Mask getMask(int maskIndex);
-		Mask getMask(string uniqueId);
-		Mask addMask(string uniqueId);
-		void removeMask(string uniqueId);
+		Mask getMask(const UniqueId & uniqueId);
+		Mask addMask(const UniqueId & uniqueId);
+		void removeMask(const UniqueId & uniqueId);
 
     private:
 		ofXml xml;
 		vector<ofXml> slices;
         vector<ofXml> masks;
+		unordered_map<UniqueId, ofXml> sliceIndex;
+		unordered_map<UniqueId, ofXml> maskIndex;
 	};
 
 	// Slices
@@ -69,7 +75,7 @@ public:
 	public:
 		Slice(ofXml x) : xml(x) {}
 
-		string getUniqueId();
+		UniqueId getUniqueId();
 
 		string getName();
 		void setName(string name);
@@ -100,7 +106,7 @@ public:
     public:
         Mask(ofXml x) : xml(x) {}
 
-		string getUniqueId();
+		UniqueId getUniqueId();
         
         string getName();
 		void setName(string name);
@@ -110,6 +116,8 @@ public:
 		bool getInverted();
 		void setInverted(bool inverted);
 		bool getClosed();
+		float getFeather(float feather = 0);
+		void setFeather(float feather);
 
         vector<glm::vec2> getPoints();
 		void setPoints(const vector<glm::vec2> & points, bool closed);
@@ -118,6 +126,8 @@ public:
     };
 
 protected:
+	void parseSource();
+
 	template<typename T>
 	static void setParam(ofXml & x, string params, string name, const T & value, string paramType = "");
 	template<typename T>
@@ -130,10 +140,18 @@ protected:
 	}
 	template<typename T>
 	static void addVertex(ofXml & x, const T & vertex);
+	// Bulk vertex lists, encoded as text in one buffer and appended as a single subtree
+	static void setVertices(ofXml & x, const string & tag, const glm::vec2 * vertices, size_t n);
+	static vector<glm::vec2> getVertices(const ofXml & x);
+	static UniqueId readUniqueId(const ofXml & x);
+	// Remove the node with this id from nodes, index and the document
+	static void removeNode(vector<ofXml> & nodes, unordered_map<UniqueId, ofXml> & index, const UniqueId & uniqueId);
 
 	ofXml xml;
 	ofXml state;
 	vector<ofXml> screens;
+	unordered_map<UniqueId, ofXml> screenIndex;
+	string source;
 };
 
 template<typename T>
@@ -0,0 +1,522 @@
+#include "ResolumeParser.h"
+
+#include "VertexCodec.h"
+#include "Tracer.h"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace ofxMapper;
+
+// Bits in found, screen fields first then the open slice or mask
+enum {
+	FOUND_SCREEN_ENABLED = 1 << 0,
+	FOUND_SCREEN_SIZE = 1 << 1,
+	FOUND_NAME = 1 << 8,
+	FOUND_ENABLED = 1 << 9,
+	FOUND_SOFT_EDGE = 1 << 10,
+	FOUND_GAMMA = 1 << 11,
+	FOUND_LUMINANCE = 1 << 12,
+	FOUND_POWER = 1 << 13,
+	FOUND_POINT_MODE = 1 << 14,
+	FOUND_CONTROL_SIZE = 1 << 15,
+	FOUND_INVERTED = 1 << 16,
+	FOUND_FEATHER = 1 << 17,
+	FOUND_CLOSED = 1 << 18,
+	FOUND_ITEM = ~0u << 8
+};
+
+//--------------------------------------------------------------
+bool ResolumeParser::Span::operator==(const char * s) const {
+	size_t n = strlen(s);
+	return n == size && memcmp(data, s, n) == 0;
+}
+
+//--------------------------------------------------------------
+bool ResolumeParser::load(const std::string & filePath) {
+	std::ifstream in(filePath, std::ios::binary);
+	if (!in)
+		return false;
+	std::ostringstream text;
+	text << in.rdbuf();
+	source = text.str();
+	return parse(source);
+}
+
+//--------------------------------------------------------------
+bool ResolumeParser::parse(const std::string & text) {
+	TraceScope trace("ResolumeParser::parse", "io");
+	version.clear();
+	compositionSize = Rect();
+	screens.clear();
+	depth = 0;
+	screenDepth = 0;
+	itemDepth = 0;
+	itemType = ITEM_NONE;
+	found = 0;
+
+	const char * p = text.data();
+	const char * end = p + text.size();
+
+	while (p < end) {
+		p = (const char *)memchr(p, '<', end - p);
+		if (!p)
+			break;
+		p++;
+		if (p >= end)
+			return false;
+
+		if (*p == '?') {
+			// Declaration or processing instruction
+			const char * q = strstr(p, "?>");
+			if (!q)
+				return false;
+			p = q + 2;
+		}
+		else if (*p == '!') {
+			if (end - p >= 3 && memcmp(p, "!--", 3) == 0) {
+				const char * q = strstr(p + 3, "-->");
+				if (!q)
+					return false;
+				p = q + 3;
+			}
+			else if (end - p >= 8 && memcmp(p, "![CDATA[", 8) == 0) {
+				const char * q = strstr(p + 8, "]]>");
+				if (!q)
+					return false;
+				p = q + 3;
+			}
+			else {
+				// DOCTYPE, may hold an internal subset in brackets
+				int nesting = 0;
+				for (; p < end; p++) {
+					if (*p == '[')
+						nesting++;
+					else if (*p == ']')
+						nesting--;
+					else if (*p == '>' && nesting <= 0)
+						break;
+				}
+				if (p >= end)
+					return false;
+				p++;
+			}
+		}
+		else if (*p == '/') {
+			const char * name = ++p;
+			while (p < end && *p != '>' && !isspace((unsigned char)*p))
+				p++;
+			if (depth == 0 || stack[depth - 1].tag.size != size_t(p - name) || memcmp(stack[depth - 1].tag.data, name, p - name) != 0)
+				return false;
+			p = (const char *)memchr(p, '>', end - p);
+			if (!p)
+				return false;
+			p++;
+			endElement();
+			depth--;
+		}
+		else if (!parseTag(p, end)) {
+			return false;
+		}
+	}
+	return depth == 0;
+}
+
+//--------------------------------------------------------------
+bool ResolumeParser::parseTag(const char *& p, const char * end) {
+	const char * name = p;
+	while (p < end && *p != '>' && *p != '/' && !isspace((unsigned char)*p))
+		p++;
+	if (p == name || p >= end)
+		return false;
+
+	if (stack.size() <= depth)
+		stack.resize(depth + 1);
+	Node & node = stack[depth++];
+	node.tag.data = name;
+	node.tag.size = p - name;
+	node.name.clear();
+
+	numAttributes = 0;
+	bool empty = false;
+	for (;;) {
+		while (p < end && isspace((unsigned char)*p))
+			p++;
+		if (p >= end)
+			return false;
+		if (*p == '>') {
+			p++;
+			break;
+		}
+		if (*p == '/') {
+			if (p + 1 >= end || p[1] != '>')
+				return false;
+			p += 2;
+			empty = true;
+			break;
+		}
+
+		const char * key = p;
+		while (p < end && *p != '=' && !isspace((unsigned char)*p))
+			p++;
+		const char * keyEnd = p;
+		while (p < end && isspace((unsigned char)*p))
+			p++;
+		if (p >= end || *p != '=')
+			return false;
+		p++;
+		while (p < end && isspace((unsigned char)*p))
+			p++;
+		if (p >= end || (*p != '"' && *p != '\''))
+			return false;
+		char quote = *p++;
+		const char * value = p;
+		p = (const char *)memchr(p, quote, end - p);
+		if (!p)
+			return false;
+
+		if (attributes.size() <= numAttributes)
+			attributes.resize(numAttributes + 1);
+		Attribute & a = attributes[numAttributes++];
+		a.key.data = key;
+		a.key.size = keyEnd - key;
+		decode(value, p, a.value);
+		p++;
+	}
+
+	getAttribute("name", node.name);
+	startElement();
+	if (empty) {
+		endElement();
+		depth--;
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+void ResolumeParser::startElement() {
+	const Span & tag = tagAt(depth);
+
+	if (depth == 2 && tag == "versionInfo" && tagAt(1) == "XmlState") {
+		getAttribute("name", version);
+	}
+	else if (tag == "CurrentCompositionTextureSize") {
+		if (compositionSize.width == 0 && compositionSize.height == 0) {
+			getAttribute("width", compositionSize.width);
+			getAttribute("height", compositionSize.height);
+		}
+	}
+	else if (tag == "Screen" && screenDepth == 0) {
+		screenDepth = depth;
+		found = 0;
+		screens.emplace_back();
+		ScreenData & screen = screens.back();
+		getAttribute("uniqueId", screen.uniqueId);
+		getAttribute("name", screen.name);
+	}
+	else if (itemType == ITEM_SLICE) {
+		startSliceElement(depth - itemDepth);
+	}
+	else if (itemType == ITEM_MASK) {
+		startMaskElement(depth - itemDepth);
+	}
+	else if (screenDepth) {
+		startScreenElement(depth - screenDepth);
+	}
+}
+
+//--------------------------------------------------------------
+void ResolumeParser::endElement() {
+	if (itemType != ITEM_NONE && depth == itemDepth) {
+		if (itemType == ITEM_SLICE && inputRect.size() == 4) {
+			SliceData & slice = screens.back().slices.back();
+			slice.inputRect.x = inputRect[0].x;
+			slice.inputRect.y = inputRect[0].y;
+			slice.inputRect.width = inputRect[2].x - inputRect[0].x;
+			slice.inputRect.height = inputRect[2].y - inputRect[0].y;
+		}
+		itemType = ITEM_NONE;
+		itemDepth = 0;
+	}
+	else if (screenDepth && depth == screenDepth) {
+		screenDepth = 0;
+	}
+}
+
+//--------------------------------------------------------------
+void ResolumeParser::startScreenElement(size_t r) {
+	ScreenData & screen = screens.back();
+	const Span & tag = tagAt(depth);
+	const Span & parent = tagAt(depth - 1);
+
+	if (r != 2)
+		return;
+
+	if (parent == "layers" && (tag == "Slice" || tag == "Mask")) {
+		itemDepth = depth;
+		found &= ~FOUND_ITEM;
+		if (tag == "Slice") {
+			itemType = ITEM_SLICE;
+			screen.slices.emplace_back();
+			getAttribute("uniqueId", screen.slices.back().uniqueId);
+			inputRect.clear();
+		}
+		else {
+			itemType = ITEM_MASK;
+			screen.masks.emplace_back();
+			getAttribute("uniqueId", screen.masks.back().uniqueId);
+		}
+	}
+	else if (parent == "OutputDevice") {
+		// First child is the output device, virtual or not
+		if (once(FOUND_SCREEN_SIZE)) {
+			getAttribute("width", screen.width);
+			getAttribute("height", screen.height);
+		}
+	}
+	else if (parent == "Params" && tag == "Param" && stack[depth - 2].name == "Params" && stack[depth - 1].name == "Enabled") {
+		if (once(FOUND_SCREEN_ENABLED))
+			getAttribute("value", screen.enabled);
+	}
+}
+
+//--------------------------------------------------------------
+void ResolumeParser::startSliceElement(size_t r) {
+	SliceData & slice = screens.back().slices.back();
+	const Span & tag = tagAt(depth);
+	const Span & t1 = tagAt(itemDepth + 1);
+	const std::string & params = stack[depth - 2].name;
+	const std::string & name = stack[depth - 1].name;
+
+	if (r == 2) {
+		const Span & t2 = tag;
+		if (t1 == "Params" && t2 == "Param") {
+			if (params == "Common" && name == "Name" && once(FOUND_NAME))
+				getAttribute("value", slice.name);
+			else if (params == "Common" && name == "Enabled" && once(FOUND_ENABLED))
+				getAttribute("value", slice.enabled);
+			else if (params == "Input" && name == "SoftEdgeEnable" && once(FOUND_SOFT_EDGE))
+				getAttribute("value", slice.softEdgeEnabled);
+		}
+		else if (t1 == "InputRect" && t2 == "v") {
+			glm::vec2 v;
+			getVertex(v);
+			inputRect.push_back(v);
+		}
+		else if (t1 == "Warper" && t2 == "BezierWarper" && once(FOUND_CONTROL_SIZE)) {
+			getAttribute("controlWidth", slice.controlWidth);
+			getAttribute("controlHeight", slice.controlHeight);
+		}
+	}
+	else if (r == 3) {
+		const Span & t2 = tagAt(itemDepth + 2);
+		if (t1 == "SoftEdgeGroup" && t2 == "Params" && tag == "ParamRange") {
+			if (name == "Gamma" && once(FOUND_GAMMA))
+				getAttribute("value", slice.softEdgeGamma);
+			else if (name == "Luminance" && once(FOUND_LUMINANCE))
+				getAttribute("value", slice.softEdgeLuminance);
+			else if (name == "Power" && once(FOUND_POWER))
+				getAttribute("value", slice.softEdgePower);
+		}
+		else if (t1 == "Warper" && t2 == "Params" && tag == "ParamChoice" && params == "Warper" && name == "Point Mode") {
+			std::string mode;
+			if (once(FOUND_POINT_MODE) && getAttribute("value", mode))
+				slice.bezierEnabled = mode == "PM_BEZIER";
+		}
+	}
+	else if (r == 4 && tag == "v" && t1 == "Warper" && tagAt(itemDepth + 2) == "BezierWarper" && tagAt(itemDepth + 3) == "vertices") {
+		glm::vec2 v;
+		getVertex(v);
+		slice.vertices.push_back(v);
+	}
+}
+
+//--------------------------------------------------------------
+void ResolumeParser::startMaskElement(size_t r) {
+	MaskData & mask = screens.back().masks.back();
+	const Span & tag = tagAt(depth);
+	const Span & t1 = tagAt(itemDepth + 1);
+	const std::string & name = stack[depth - 1].name;
+
+	if (r == 2 && t1 == "Params") {
+		if (tag == "Param") {
+			if (name == "Name" && once(FOUND_NAME))
+				getAttribute("value", mask.name);
+			else if (name == "Enabled" && once(FOUND_ENABLED))
+				getAttribute("value", mask.enabled);
+			else if (name == "Invert" && once(FOUND_INVERTED))
+				getAttribute("value", mask.inverted);
+		}
+		else if (tag == "ParamRange" && name == "Feather" && once(FOUND_FEATHER)) {
+			getAttribute("value", mask.feather);
+		}
+	}
+	else if ((r == 3 || r == 5) && t1 == "ShapeObject" && tagAt(itemDepth + 2) == "Shape" && tagAt(itemDepth + 3) == "Contour") {
+		if (r == 3 && once(FOUND_CLOSED)) {
+			getAttribute("closed", mask.closed);
+		}
+		else if (r == 5 && tag == "v" && tagAt(itemDepth + 4) == "points") {
+			glm::vec2 v;
+			getVertex(v);
+			mask.points.push_back(v);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+const ResolumeParser::Span & ResolumeParser::tagAt(size_t level) const {
+	return stack[level - 1].tag;
+}
+
+//--------------------------------------------------------------
+const std::string * ResolumeParser::getAttribute(const char * key) const {
+	for (size_t i = 0; i < numAttributes; i++) {
+		if (attributes[i].key == key)
+			return &attributes[i].value;
+	}
+	return NULL;
+}
+
+//--------------------------------------------------------------
+bool ResolumeParser::getAttribute(const char * key, std::string & value) const {
+	const std::string * a = getAttribute(key);
+	if (a)
+		value = *a;
+	return a != NULL;
+}
+
+//--------------------------------------------------------------
+bool ResolumeParser::getAttribute(const char * key, UniqueId & value) const {
+	const std::string * a = getAttribute(key);
+	if (a)
+		value = UniqueId::parse(*a);
+	return a != NULL;
+}
+
+//--------------------------------------------------------------
+bool ResolumeParser::getAttribute(const char * key, bool & value) const {
+	const std::string * a = getAttribute(key);
+	if (!a)
+		return false;
+	// Same rule as pugixml as_bool
+	char c = a->empty() ? 0 : (*a)[0];
+	value = c == '1' || c == 't' || c == 'T' || c == 'y' || c == 'Y';
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ResolumeParser::getAttribute(const char * key, int & value) const {
+	float f;
+	if (!getAttribute(key, f))
+		return false;
+	value = int(f);
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ResolumeParser::getAttribute(const char * key, size_t & value) const {
+	float f;
+	if (!getAttribute(key, f) || f < 0)
+		return false;
+	value = size_t(f);
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ResolumeParser::getAttribute(const char * key, float & value) const {
+	const std::string * a = getAttribute(key);
+	return a && VertexCodec::parseFloat(*a, value);
+}
+
+//--------------------------------------------------------------
+bool ResolumeParser::getVertex(glm::vec2 & v) const {
+	v = glm::vec2();
+	bool x = getAttribute("x", v.x);
+	bool y = getAttribute("y", v.y);
+	return x && y;
+}
+
+//--------------------------------------------------------------
+bool ResolumeParser::once(unsigned int bit) {
+	if (found & bit)
+		return false;
+	found |= bit;
+	return true;
+}
+
+//--------------------------------------------------------------
+void ResolumeParser::decode(const char * begin, const char * end, std::string & out) {
+	const char * amp = (const char *)memchr(begin, '&', end - begin);
+	if (!amp) {
+		out.assign(begin, end);
+		return;
+	}
+
+	out.assign(begin, amp);
+	const char * p = amp;
+	while (p < end) {
+		if (*p != '&') {
+			out += *p++;
+			continue;
+		}
+		const char * semi = (const char *)memchr(p, ';', end - p);
+		if (!semi) {
+			out.append(p, end);
+			break;
+		}
+		std::string entity(p + 1, semi);
+		if (entity == "lt") out += '<';
+		else if (entity == "gt") out += '>';
+		else if (entity == "amp") out += '&';
+		else if (entity == "quot") out += '"';
+		else if (entity == "apos") out += '\'';
+		else if (entity.size() > 1 && entity[0] == '#') {
+			unsigned long c = entity[1] == 'x' ?
+				strtoul(entity.c_str() + 2, NULL, 16) :
+				strtoul(entity.c_str() + 1, NULL, 10);
+			// UTF-8
+			if (c < 0x80) {
+				out += char(c);
+			}
+			else if (c < 0x800) {
+				out += char(0xC0 | (c >> 6));
+				out += char(0x80 | (c & 0x3F));
+			}
+			else if (c < 0x10000) {
+				out += char(0xE0 | (c >> 12));
+				out += char(0x80 | ((c >> 6) & 0x3F));
+				out += char(0x80 | (c & 0x3F));
+			}
+			else {
+				out += char(0xF0 | (c >> 18));
+				out += char(0x80 | ((c >> 12) & 0x3F));
+				out += char(0x80 | ((c >> 6) & 0x3F));
+				out += char(0x80 | (c & 0x3F));
+			}
+		}
+		else {
+			out.append(p, semi + 1);
+		}
+		p = semi + 1;
+	}
+}
+
+//--------------------------------------------------------------
+bool ResolumeParser::isValid(const std::string & versionName) const {
+	return version == versionName;
+}
+
+//--------------------------------------------------------------
+Rect ResolumeParser::getCompositionSize() const {
+	return compositionSize;
+}
+
+//--------------------------------------------------------------
+std::vector<ScreenData> & ResolumeParser::getScreens() {
+	return screens;
+}
+
+//--------------------------------------------------------------
+std::string & ResolumeParser::getSource() {
+	return source;
+}
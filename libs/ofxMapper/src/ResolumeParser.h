@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "MapperData.h"
+
+// Single pass reader for Resolume screen setup files. Screens, slices and masks are read
+// straight into ScreenData while scanning the text, without building a DOM or running
+// any XPath queries. Unknown nodes are skipped, ResolumeFile keeps them for saving.
+class ResolumeParser {
+public:
+
+	// filePath is opened as given, not resolved against the data folder
+	bool load(const std::string & filePath);
+	bool parse(const std::string & text);
+
+	bool isValid(const std::string & versionName) const;
+	ofxMapper::Rect getCompositionSize() const;
+	std::vector<ofxMapper::ScreenData> & getScreens();
+
+	// Text of the last loaded file
+	std::string & getSource();
+
+private:
+	struct Span {
+		const char * data = NULL;
+		size_t size = 0;
+		bool operator==(const char * s) const;
+		bool operator!=(const char * s) const { return !(*this == s); }
+	};
+
+	struct Node {
+		Span tag;
+		std::string name;
+	};
+
+	struct Attribute {
+		Span key;
+		std::string value;
+	};
+
+	enum ItemType {
+		ITEM_NONE, ITEM_SLICE, ITEM_MASK
+	};
+
+	bool parseTag(const char *& p, const char * end);
+	void startElement();
+	void endElement();
+	void startScreenElement(size_t r);
+	void startSliceElement(size_t r);
+	void startMaskElement(size_t r);
+
+	const Span & tagAt(size_t depth) const;
+	const std::string * getAttribute(const char * key) const;
+	bool getAttribute(const char * key, std::string & value) const;
+	bool getAttribute(const char * key, UniqueId & value) const;
+	bool getAttribute(const char * key, bool & value) const;
+	bool getAttribute(const char * key, int & value) const;
+	bool getAttribute(const char * key, size_t & value) const;
+	bool getAttribute(const char * key, float & value) const;
+	bool getVertex(glm::vec2 & v) const;
+	// First match only, like findFirst
+	bool once(unsigned int bit);
+
+	static void decode(const char * begin, const char * end, std::string & out);
+
+	std::string source;
+	std::string version;
+	ofxMapper::Rect compositionSize;
+	std::vector<ofxMapper::ScreenData> screens;
+
+	std::vector<Node> stack;
+	size_t depth = 0;
+	std::vector<Attribute> attributes;
+	size_t numAttributes = 0;
+
+	size_t screenDepth = 0;
+	size_t itemDepth = 0;
+	ItemType itemType = ITEM_NONE;
+	unsigned int found = 0;
+	std::vector<glm::vec2> inputRect;
+};
@@ -0,0 +1,190 @@
+#include "ScanlineRasterizer.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//--------------------------------------------------------------
+void ScanlineRasterizer::fill(const std::vector<glm::vec2> & contour, FillRule rule, size_t width, size_t height, unsigned char * coverage) {
+	quad.resize(1);
+	quad[0] = contour;
+	fill(quad, rule, width, height, coverage);
+}
+
+//--------------------------------------------------------------
+void ScanlineRasterizer::fill(const std::vector<std::vector<glm::vec2>> & contours, FillRule rule, size_t width, size_t height, unsigned char * coverage) {
+
+	if (width == 0 || height == 0)
+		return;
+
+	// Edge list, sorted by top
+	edges.clear();
+	float ymin = std::numeric_limits<float>::max();
+	float ymax = std::numeric_limits<float>::lowest();
+	for (auto & contour : contours) {
+		size_t n = contour.size();
+		for (size_t i = 0; i < n; i++) {
+			const glm::vec2 & a = contour[i];
+			const glm::vec2 & b = contour[(i + 1) % n];
+			if (a.y == b.y)
+				continue;
+			Edge e;
+			if (a.y < b.y) {
+				e.y0 = a.y; e.y1 = b.y; e.x0 = a.x; e.dir = 1;
+			}
+			else {
+				e.y0 = b.y; e.y1 = a.y; e.x0 = b.x; e.dir = -1;
+			}
+			e.dxdy = (b.x - a.x) / (b.y - a.y);
+			edges.push_back(e);
+			ymin = std::min(ymin, e.y0);
+			ymax = std::max(ymax, e.y1);
+		}
+	}
+	if (edges.empty())
+		return;
+
+	std::sort(edges.begin(), edges.end(), [](const Edge & a, const Edge & b) {
+		return a.y0 < b.y0;
+	});
+
+	int row0 = std::max(0, (int)floorf(ymin));
+	int row1 = std::min((int)height - 1, (int)ceilf(ymax));
+
+	partial.assign(width + 1, 0.f);
+	full.assign(width + 1, 0.f);
+	active.clear();
+	size_t nextEdge = 0;
+
+	const float weight = 1.f / subScanlines;
+
+	for (int row = row0; row <= row1; row++) {
+
+		bool touched = false;
+
+		for (int s = 0; s < subScanlines; s++) {
+			float sy = row + (s + 0.5f) * weight;
+
+			// Update active edges
+			while (nextEdge < edges.size() && edges[nextEdge].y0 <= sy) {
+				active.push_back(&edges[nextEdge]);
+				nextEdge++;
+			}
+			active.erase(std::remove_if(active.begin(), active.end(), [sy](Edge * e) {
+				return e->y1 <= sy;
+			}), active.end());
+
+			crossings.clear();
+			for (Edge * e : active) {
+				if (e->y0 <= sy)
+					crossings.push_back(std::make_pair(e->x0 + (sy - e->y0) * e->dxdy, e->dir));
+			}
+			if (crossings.empty())
+				continue;
+			std::sort(crossings.begin(), crossings.end());
+
+			// Walk crossings and emit inside spans
+			int winding = 0;
+			float spanStart = 0;
+			for (auto & c : crossings) {
+				bool wasInside = rule == FILL_ODD ? (winding & 1) != 0 : winding != 0;
+				winding += c.second;
+				bool inside = rule == FILL_ODD ? (winding & 1) != 0 : winding != 0;
+				if (inside && !wasInside) {
+					spanStart = c.first;
+				}
+				else if (!inside && wasInside) {
+					addSpan(spanStart, c.first, weight, width);
+					touched = true;
+				}
+			}
+		}
+
+		if (!touched)
+			continue;
+
+		// Resolve row
+		unsigned char * out = coverage + row * width;
+		float run = 0;
+		for (size_t x = 0; x < width; x++) {
+			run += full[x];
+			float c = std::min(1.f, partial[x] + run);
+			unsigned char v = (unsigned char)(c * 255.f + 0.5f);
+			if (v > out[x])
+				out[x] = v;
+			partial[x] = 0;
+			full[x] = 0;
+		}
+		full[width] = 0;
+		partial[width] = 0;
+	}
+}
+
+//--------------------------------------------------------------
+void ScanlineRasterizer::addSpan(float x0, float x1, float weight, size_t width) {
+	x0 = std::max(0.f, x0);
+	x1 = std::min((float)width, x1);
+	if (x1 <= x0)
+		return;
+
+	size_t i0 = (size_t)x0;
+	size_t i1 = (size_t)x1;
+	if (i0 == i1) {
+		partial[i0] += (x1 - x0) * weight;
+		return;
+	}
+	partial[i0] += (i0 + 1 - x0) * weight;
+	full[i0 + 1] += weight;
+	full[i1] -= weight;
+	if (i1 < width)
+		partial[i1] += (x1 - i1) * weight;
+}
+
+//--------------------------------------------------------------
+void ScanlineRasterizer::stroke(const std::vector<glm::vec2> & points, bool closed, float lineWidth, size_t width, size_t height, unsigned char * coverage) {
+	size_t n = points.size();
+	size_t segments = closed ? n : n - 1;
+	if (n < 2)
+		return;
+
+	float r = lineWidth * 0.5f;
+	std::vector<glm::vec2> q(4);
+
+	// Each segment is filled on its own so overlapping segments don't cancel out
+	for (size_t i = 0; i < segments; i++) {
+		const glm::vec2 & a = points[i];
+		const glm::vec2 & b = points[(i + 1) % n];
+		glm::vec2 d = b - a;
+		float len = glm::length(d);
+		if (len <= 0)
+			continue;
+		glm::vec2 t = d * (r / len);
+		glm::vec2 nrm(-t.y, t.x);
+		q[0] = a - t + nrm;
+		q[1] = b + t + nrm;
+		q[2] = b + t - nrm;
+		q[3] = a - t - nrm;
+		fill(q, FILL_NONZERO, width, height, coverage);
+	}
+}
+
+//--------------------------------------------------------------
+size_t ScanlineRasterizer::getMemoryUsage() const {
+	size_t n = edges.capacity() * sizeof(Edge) + active.capacity() * sizeof(Edge *)
+		+ crossings.capacity() * sizeof(std::pair<float, int>)
+		+ (partial.capacity() + full.capacity()) * sizeof(float)
+		+ quad.capacity() * sizeof(std::vector<glm::vec2>);
+	for (auto & q : quad) {
+		n += q.capacity() * sizeof(glm::vec2);
+	}
+	return n;
+}
+
+//--------------------------------------------------------------
+void ScanlineRasterizer::compact() {
+	std::vector<Edge>().swap(edges);
+	std::vector<Edge *>().swap(active);
+	std::vector<std::pair<float, int>>().swap(crossings);
+	std::vector<float>().swap(partial);
+	std::vector<float>().swap(full);
+	std::vector<std::vector<glm::vec2>>().swap(quad);
+}
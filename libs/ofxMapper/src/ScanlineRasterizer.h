@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "glm/glm.hpp"
+
+// Anti-aliased polygon filler writing 8-bit coverage.
+// Coverage is exact horizontally and supersampled vertically.
+class ScanlineRasterizer {
+public:
+	enum FillRule { FILL_ODD, FILL_NONZERO };
+
+	static const int subScanlines = 4;
+
+	// Fill contours into coverage (width * height bytes). Existing coverage is kept where higher.
+	void fill(const std::vector<std::vector<glm::vec2>> & contours, FillRule rule, size_t width, size_t height, unsigned char * coverage);
+	void fill(const std::vector<glm::vec2> & contour, FillRule rule, size_t width, size_t height, unsigned char * coverage);
+
+	// Stroke an open or closed polyline with the given line width
+	void stroke(const std::vector<glm::vec2> & points, bool closed, float lineWidth, size_t width, size_t height, unsigned char * coverage);
+
+	// Heap bytes of the scratch buffers, by capacity
+	size_t getMemoryUsage() const;
+	// Release the scratch buffers, they grow again on the next fill
+	void compact();
+
+private:
+	struct Edge {
+		float y0;
+		float y1;
+		float x0;
+		float dxdy;
+		int dir;
+	};
+
+	void addSpan(float x0, float x1, float weight, size_t width);
+
+	// Scratch buffers, reused between calls
+	std::vector<Edge> edges;
+	std::vector<Edge *> active;
+	std::vector<std::pair<float, int>> crossings;
+	std::vector<float> partial;
+	std::vector<float> full;
+	std::vector<std::vector<glm::vec2>> quad;
+};
@@ -1,4 +1,5 @@
 #include "Screen.h"
+#include "Profiler.h"
 
 using namespace ofxMapper;
 
@@ -8,21 +9,40 @@ Screen::Screen(int w, int h) {
 }
 
 //--------------------------------------------------------------
-Screen::Screen(int x, int y, int w, int h) {
-	uniqueId = ofToString((uint64_t)ofRandom(9999999999999));
+Screen::Screen(int x, int y, int w, int h) : Screen(x, y, w, h, true) {
+}
+
+//--------------------------------------------------------------
+Screen::Screen(int x, int y, int w, int h, bool allocate) {
+	uniqueId = UniqueId::create();
+	allocationDeferred = !allocate;
 
 	posX = x;
 	posY = y;
 
     width.addListener(this, &Screen::resolutionChanged);
 	height.addListener(this, &Screen::resolutionChanged);
-	samples.setMax(ofFbo::maxSamples());
+	if (allocate)
+		samples.setMax(ofFbo::maxSamples());
 	samples.addListener(this, &Screen::resolutionChanged);
 
     width.setWithoutEventNotifications(w);
     height.set(h);
 }
 
+//--------------------------------------------------------------
+void Screen::allocate() {
+	if (!allocationDeferred)
+		return;
+	allocationDeferred = false;
+	samples.setMax(ofFbo::maxSamples());
+	if (allocationPending) {
+		allocationPending = false;
+		int w = width;
+		resolutionChanged(w);
+	}
+}
+
 //--------------------------------------------------------------
 Screen::~Screen() {
 	width.removeListener(this, &Screen::resolutionChanged);
@@ -51,26 +71,40 @@ void Screen::update(ofTexture & inputTexture) {
 	fbo.begin();
 	ofClear(0);
 
+	render(inputTexture);
+
+	fbo.end();
+}
+
+//--------------------------------------------------------------
+void Screen::render(ofTexture & inputTexture) {
+
+	ProfileScope scope(STAGE_SCREEN_UPDATE);
+	flush();
+
 	inputTexture.bind();
 
 	for (SlicePtr slice : slices) {
 		if (slice->enabled) {
-			slice->draw();
+			slice->draw(colorLut);
 		}
 	}
 
 	inputTexture.unbind();
 
-	ofPushStyle();
-	ofSetColor(ofColor::black);
-	for (MaskPtr mask : masks) {
-		if (mask->enabled) {
-			mask->draw();
-		}
+	// Masks are baked into one texture that darkens the slices underneath
+	updateMaskCoverage();
+	if (!maskTextureEmpty) {
+		ProfileScope scope(STAGE_MASK_DRAW);
+		Profiler::count(COUNTER_DRAW_CALLS);
+		Profiler::count(COUNTER_VERTICES, 4);
+		Profiler::count(COUNTER_TRIANGLES, 2);
+		ofPushStyle();
+		ofEnableBlendMode(OF_BLENDMODE_MULTIPLY);
+		ofSetColor(ofColor::white);
+		maskTexture.draw(0, 0, width, height);
+		ofPopStyle();
 	}
-	ofPopStyle();
-
-	fbo.end();
 }
 
 //--------------------------------------------------------------
@@ -81,7 +115,78 @@ void Screen::draw() {
 //--------------------------------------------------------------
 void Screen::draw(const ofRectangle & rect) {
 
-	fbo.draw(rect);
+	if (atlas)
+		atlas->getTexture().drawSubsection(rect.x, rect.y, rect.width, rect.height, atlasRect.x, atlasRect.y, atlasRect.width, atlasRect.height);
+	else
+		fbo.draw(rect);
+}
+
+//--------------------------------------------------------------
+bool Screen::loadColorLut(string filePath) {
+	ColorLutPtr lut(new ColorLut);
+	if (!lut->load(filePath))
+		return false;
+	colorLut = lut;
+	return true;
+}
+
+//--------------------------------------------------------------
+void Screen::setColorLut(ColorLutPtr lut) {
+	colorLut = lut;
+}
+
+//--------------------------------------------------------------
+ColorLutPtr Screen::getColorLut() const {
+	return colorLut;
+}
+
+//--------------------------------------------------------------
+void Screen::drawDirect(ofTexture & inputTexture) {
+	drawDirect(inputTexture, getScreenRect());
+}
+
+//--------------------------------------------------------------
+void Screen::drawDirect(ofTexture & inputTexture, const ofRectangle & rect) {
+	ofPushView();
+	ofViewport(rect);
+	ofSetupScreenPerspective(width, height);
+
+	// Opaque black under the slices, like the cleared frame buffer
+	ofPushStyle();
+	ofEnableBlendMode(OF_BLENDMODE_DISABLED);
+	ofSetColor(ofColor::black);
+	ofFill();
+	ofDrawRectangle(0, 0, width, height);
+	ofPopStyle();
+	Profiler::count(COUNTER_DRAW_CALLS);
+
+	render(inputTexture);
+	ofPopView();
+}
+
+//--------------------------------------------------------------
+void Screen::setFboRequired(bool required) {
+	if (fboRequired == required)
+		return;
+	fboRequired = required;
+	if (direct) {
+		int w = width;
+		resolutionChanged(w);
+	}
+}
+
+//--------------------------------------------------------------
+void Screen::setDirect(bool direct) {
+	if (this->direct == direct)
+		return;
+	this->direct = direct;
+	int w = width;
+	resolutionChanged(w);
+}
+
+//--------------------------------------------------------------
+bool Screen::isFboRequired() const {
+	return fboRequired || samples > 0;
 }
 
 //--------------------------------------------------------------
@@ -89,6 +194,30 @@ const ofFbo & Screen::getFbo() const {
 	return fbo;
 }
 
+//--------------------------------------------------------------
+bool Screen::isInAtlas() const {
+	return atlas != NULL;
+}
+
+//--------------------------------------------------------------
+ofRectangle Screen::getAtlasRect() const {
+	return atlasRect;
+}
+
+//--------------------------------------------------------------
+void Screen::setAtlas(const ofFbo * a, const ofRectangle & rect) {
+	bool wasInAtlas = atlas != NULL;
+	atlas = a;
+	atlasRect = rect;
+	if (atlas) {
+		fbo.clear();
+	}
+	else if (wasInAtlas) {
+		int w = width;
+		resolutionChanged(w);
+	}
+}
+
 //--------------------------------------------------------------
 vector<SlicePtr> & Screen::getSlices() {
     return slices;
@@ -104,13 +233,14 @@ SlicePtr Screen::getSlice(size_t sliceIndex) {
 	return slices[sliceIndex];
 }
 
+//--------------------------------------------------------------
+SlicePtr Screen::getSlice(const UniqueId & uniqueId) {
+	return sliceIndex.find(slices, uniqueId);
+}
+
 //--------------------------------------------------------------
 SlicePtr Screen::getSlice(string uniqueId) {
-	for (SlicePtr slice: slices) {
-		if (slice->uniqueId == uniqueId)
-			return slice;
-	}
-	return NULL;
+	return getSlice(UniqueId::parse(uniqueId));
 }
 
 //--------------------------------------------------------------
@@ -129,6 +259,7 @@ SlicePtr Screen::addSlice(string name, const ofRectangle & inputRect, const ofRe
     SlicePtr slice = slices.back();
 	slice->name = name;
 	slice->createVertices(outputRect);
+	sliceIndex.insert(slice);
 	return slice;
 }
 
@@ -137,8 +268,19 @@ SlicePtr Screen::addSlice(string name, const ofRectangle & inputRect) {
 	return addSlice(name, inputRect, ofRectangle(0, 0, width, height));
 }
 
+//--------------------------------------------------------------
+SlicePtr Screen::addSlice(const SliceData & data) {
+	const ofRectangle & r = data.inputRect;
+	slices.emplace_back(new Slice(r.x, r.y, r.width, r.height));
+	SlicePtr slice = slices.back();
+	slice->set(data, ofRectangle(0, 0, width, height));
+	sliceIndex.insert(slice);
+	return slice;
+}
+
 //--------------------------------------------------------------
 void Screen::removeSlice(size_t sliceIndex) {
+	this->sliceIndex.erase(slices[sliceIndex]);
 	slices.erase(slices.begin() + sliceIndex);
 }
 
@@ -218,13 +360,14 @@ MaskPtr Screen::getMask(size_t maskIndex) {
     return masks[maskIndex];
 }
 
+//--------------------------------------------------------------
+MaskPtr Screen::getMask(const UniqueId & uniqueId) {
+	return maskIndex.find(masks, uniqueId);
+}
+
 //--------------------------------------------------------------
 MaskPtr Screen::getMask(string uniqueId) {
-	for (MaskPtr mask : masks) {
-		if (mask->uniqueId == uniqueId)
-			return mask;
-	}
-	return NULL;
+	return getMask(UniqueId::parse(uniqueId));
 }
 
 //--------------------------------------------------------------
@@ -233,14 +376,25 @@ MaskPtr Screen::addMask(string name) {
     mask->name = name;
     mask->setScreenRect(getScreenRect());
     masks.push_back(mask);
+    maskIndex.insert(mask);
     return mask;
 }
 
+//--------------------------------------------------------------
+MaskPtr Screen::addMask(const MaskData & data) {
+	MaskPtr mask(new Mask);
+	mask->set(data, getScreenRect());
+	masks.push_back(mask);
+	maskIndex.insert(mask);
+	return mask;
+}
+
 //--------------------------------------------------------------
 void Screen::removeMaskSelected() {
 	for (auto it = masks.begin(); it != masks.end(); ) {
 		MaskPtr mask = *it;
 		if (mask->selected && !mask->removeHandleSelected()) {
+			maskIndex.erase(mask);
 			it = masks.erase(it);
 		}
 		else
@@ -255,21 +409,117 @@ void Screen::deselectMasks() {
     }
 }
 
+//--------------------------------------------------------------
+const ofPixels & Screen::getMaskCoverage() {
+	updateMaskCoverage();
+	return maskCoverage;
+}
+
+//--------------------------------------------------------------
+void Screen::updateMaskCoverage() {
+
+	ProfileScope scope(STAGE_MASK_UPDATE);
+	flush();
+
+	vector<MaskState> state;
+	state.reserve(masks.size());
+	for (MaskPtr mask : masks) {
+		state.push_back({ mask.get(), mask->getRevision(), mask->enabled });
+	}
+	if (state == maskState && maskCoverage.getWidth() == (size_t)width && maskCoverage.getHeight() == (size_t)height)
+		return;
+	maskState = state;
+
+	size_t w = width;
+	size_t h = height;
+	maskCoverage.allocate(w, h, 1);
+	maskCoverage.set(0);
+	unsigned char * coverage = maskCoverage.getData();
+
+	vector<vector<glm::vec2>> contours;
+	bool empty = true;
+
+	for (MaskPtr mask : masks) {
+		if (!mask->enabled)
+			continue;
+
+		auto & polylines = mask->getPolylines();
+		contours.clear();
+		for (auto & poly : polylines) {
+			if (poly.size() == 0)
+				continue;
+			contours.emplace_back();
+			for (auto & v : poly.getVertices())
+				contours.back().push_back(glm::vec2(v));
+		}
+		if (contours.empty())
+			continue;
+
+		if (mask->closed && mask->feather > 0) {
+			// Feather from the distance to the mask outline only, not the screen edges
+			contours.resize(1);
+			distanceField.compute(contours, w, h, mask->feather);
+			distanceField.fillCoverage(mask->feather, mask->inverted, coverage);
+		}
+		else if (mask->closed)
+			rasterizer.fill(contours, ScanlineRasterizer::FILL_ODD, w, h, coverage);
+		else
+			rasterizer.stroke(contours[0], false, 1.f, w, h, coverage);
+		empty = false;
+	}
+
+	maskTextureEmpty = empty;
+	if (empty)
+		return;
+
+	// Texture holds visibility, so drawing it with multiply blending applies the masks
+	ofPixels visibility;
+	visibility.allocate(w, h, 1);
+	unsigned char * v = visibility.getData();
+	for (size_t i = 0; i < w * h; i++) {
+		v[i] = 255 - coverage[i];
+	}
+	maskTexture.loadData(visibility);
+}
+
 //--------------------------------------------------------------
 bool Screen::grabSlice(const glm::vec2 & p, float radius) {
-	bool selected = false;
-	for (SlicePtr slice : slices) {
-		if (slice->editEnabled && slice->grabHandle(p, radius)) {
-			slice->selected = true;
+	flush();
+	updateSlicePickGrid();
+	const vector<size_t> & candidates = queryPickGrid(slicePickGrid, p, radius);
+
+	// Slices away from p can't be hit and only drop their previous grab
+	size_t c = 0;
+	for (size_t i = 0; i < slices.size(); i++) {
+		Slice & slice = *slices[i];
+		bool near = c < candidates.size() && candidates[c] == i;
+		if (near)
+			c++;
+		if (!slice.editEnabled)
+			continue;
+		if (!near) {
+			slice.deselectAllHandles();
+		}
+		else if (slice.grabHandle(p, radius)) {
+			slice.selected = true;
 			return true;
 		}
 	}
-	for (SlicePtr slice : slices) {
-		if (slice->editEnabled) {
-			if (slice->grab(p))
+
+	bool selected = false;
+	c = 0;
+	for (size_t i = 0; i < slices.size(); i++) {
+		Slice & slice = *slices[i];
+		if (c == candidates.size() || candidates[c] != i) {
+			slice.selected = false;
+			continue;
+		}
+		c++;
+		if (slice.editEnabled) {
+			if (slice.grab(p))
 				selected = true;
 		}
-		else if (slice->select(p)) {
+		else if (slice.select(p)) {
 			selected = true;
 		}
 	}
@@ -302,27 +552,209 @@ void ofxMapper::Screen::releaseSlice() {
 	}
 }
 
+//--------------------------------------------------------------
+size_t Screen::selectHandles(const ofRectangle & rect, bool add) {
+	size_t n = 0;
+	for (auto & slice : slices) {
+		if (slice->editEnabled)
+			n += slice->selectHandles(rect, add);
+		else if (!add)
+			slice->deselectHandles();
+	}
+	return n;
+}
+
+//--------------------------------------------------------------
+size_t Screen::selectHandles(const ofPolyline & lasso, bool add) {
+	size_t n = 0;
+	for (auto & slice : slices) {
+		if (slice->editEnabled)
+			n += slice->selectHandles(lasso, add);
+		else if (!add)
+			slice->deselectHandles();
+	}
+	return n;
+}
+
+//--------------------------------------------------------------
+void Screen::deselectHandles() {
+	for (auto & slice : slices) {
+		slice->deselectHandles();
+	}
+}
+
+//--------------------------------------------------------------
+size_t Screen::getNumSelectedHandles() {
+	size_t n = 0;
+	for (auto & slice : slices) {
+		n += slice->getNumSelectedHandles();
+	}
+	return n;
+}
+
+//--------------------------------------------------------------
+ofRectangle Screen::getSelectedHandleBounds() {
+	ofRectangle bounds;
+	bool first = true;
+	for (auto & slice : slices) {
+		if (slice->getNumSelectedHandles() == 0)
+			continue;
+		ofRectangle r = slice->getSelectedHandleBounds();
+		if (first)
+			bounds = r;
+		else
+			bounds.growToInclude(r);
+		first = false;
+	}
+	return bounds;
+}
+
+//--------------------------------------------------------------
+void Screen::transformSelectedHandles(const glm::mat3 & m) {
+	for (auto & slice : slices) {
+		if (slice->editEnabled)
+			slice->transformSelectedHandles(m);
+	}
+}
+
+//--------------------------------------------------------------
+void Screen::translateSelectedHandles(const glm::vec2 & delta) {
+	transformSelectedHandles(VertexTransform::getTranslation(delta));
+}
+
+//--------------------------------------------------------------
+void Screen::scaleSelectedHandles(const glm::vec2 & scale, const glm::vec2 & origin) {
+	transformSelectedHandles(VertexTransform::getScale(scale, origin));
+}
+
+//--------------------------------------------------------------
+void Screen::rotateSelectedHandles(float radians, const glm::vec2 & origin) {
+	transformSelectedHandles(VertexTransform::getRotation(radians, origin));
+}
+
+//--------------------------------------------------------------
+void Screen::warpSelectedHandles(const glm::vec2 dst[4]) {
+	ofRectangle r = getSelectedHandleBounds();
+	glm::vec2 src[4] = {
+		glm::vec2(r.getLeft(), r.getTop()),
+		glm::vec2(r.getRight(), r.getTop()),
+		glm::vec2(r.getRight(), r.getBottom()),
+		glm::vec2(r.getLeft(), r.getBottom()),
+	};
+	transformSelectedHandles(VertexTransform::getPerspective(src, dst));
+}
+
 //--------------------------------------------------------------
 bool Screen::grabMask(const glm::vec2 & p, float radius) {
-	bool selected = false;
-	for (MaskPtr mask : masks) {
-		if (mask->editEnabled && mask->grabHandle(p, radius)) {
-			mask->selected = true;
+	flush();
+	updateMaskPickGrid();
+	const vector<size_t> & candidates = queryPickGrid(maskPickGrid, p, radius);
+
+	// Masks away from p can't be hit and only drop their previous grab
+	size_t c = 0;
+	for (size_t i = 0; i < masks.size(); i++) {
+		Mask & mask = *masks[i];
+		bool near = c < candidates.size() && candidates[c] == i;
+		if (near)
+			c++;
+		if (!mask.editEnabled)
+			continue;
+		if (!near) {
+			mask.deselectHandles();
+		}
+		else if (mask.grabHandle(p, radius)) {
+			mask.selected = true;
 			return true;
 		}
 	}
-	for (MaskPtr mask : masks) {
-		if (mask->editEnabled) {
-			if (mask->grab(p))
+
+	bool selected = false;
+	c = 0;
+	for (size_t i = 0; i < masks.size(); i++) {
+		Mask & mask = *masks[i];
+		if (c == candidates.size() || candidates[c] != i) {
+			mask.selected = false;
+			continue;
+		}
+		c++;
+		if (mask.editEnabled) {
+			if (mask.grab(p))
 				selected = true;
 		}
-		else if (mask->select(p)) {
+		else if (mask.select(p)) {
 			selected = true;
 		}
 	}
 	return selected;
 }
 
+//--------------------------------------------------------------
+void Screen::updateSlicePickGrid() {
+	pickState.clear();
+	for (auto & slice : slices) {
+		pickState.push_back({ slice.get(), slice->uniqueId, slice->getRebuildCount() });
+	}
+	if (pickState == slicePickState)
+		return;
+	slicePickState.swap(pickState);
+
+	pickBounds.clear();
+	for (auto & slice : slices) {
+		pickBounds.push_back(slice->getBounds());
+	}
+	buildPickGrid(slicePickGrid);
+}
+
+//--------------------------------------------------------------
+void Screen::updateMaskPickGrid() {
+	pickState.clear();
+	for (auto & mask : masks) {
+		pickState.push_back({ mask.get(), mask->uniqueId, mask->getRevision() });
+	}
+	if (pickState == maskPickState)
+		return;
+	maskPickState.swap(pickState);
+
+	pickBounds.clear();
+	for (auto & mask : masks) {
+		pickBounds.push_back(mask->getBounds());
+	}
+	buildPickGrid(maskPickGrid);
+}
+
+//--------------------------------------------------------------
+void Screen::buildPickGrid(SpatialGrid & grid) {
+	// Cells about the size of an element, and at least a 16th of the largest one so
+	// no element spans too many cells
+	vector<glm::vec2> centers;
+	float sum = 0;
+	float largest = 0;
+	for (auto & r : pickBounds) {
+		centers.push_back(r.getCenter());
+		float size = std::max(r.width, r.height);
+		sum += size;
+		largest = std::max(largest, size);
+	}
+	float cellSize = SpatialGrid::getCellSize(centers);
+	if (!pickBounds.empty())
+		cellSize = std::max(cellSize, std::max(sum / pickBounds.size(), largest / 16));
+
+	grid.clear(cellSize);
+	for (size_t i = 0; i < pickBounds.size(); i++) {
+		const ofRectangle & r = pickBounds[i];
+		grid.insert(i, glm::vec2(r.getMinX(), r.getMinY()), glm::vec2(r.getMaxX(), r.getMaxY()));
+	}
+}
+
+//--------------------------------------------------------------
+const vector<size_t> & Screen::queryPickGrid(const SpatialGrid & grid, const glm::vec2 & p, float radius) {
+	pickCandidates.clear();
+	grid.query(p, radius, pickCandidates);
+	std::sort(pickCandidates.begin(), pickCandidates.end());
+	pickCandidates.erase(std::unique(pickCandidates.begin(), pickCandidates.end()), pickCandidates.end());
+	return pickCandidates;
+}
+
 //--------------------------------------------------------------
 void ofxMapper::Screen::moveMask(const glm::vec2 & delta) {
 	for (MaskPtr mask : masks) {
@@ -352,6 +784,8 @@ void ofxMapper::Screen::releaseMask() {
 //--------------------------------------------------------------
 void Screen::drawHandles(int handleSize, int handleType) {
 
+	flush();
+
 	float radius = handleSize / 2;
 
 	ofPushStyle();
@@ -388,6 +822,166 @@ void Screen::drawHandles(int handleSize, int handleType) {
 	ofPopStyle();
 }
 
+//--------------------------------------------------------------
+void Screen::flush() {
+	for (auto & slice : slices) {
+		slice->flush();
+	}
+	for (auto & mask : masks) {
+		mask->flush();
+	}
+}
+
+//--------------------------------------------------------------
+unsigned int Screen::getRebuildCount() const {
+	unsigned int n = 0;
+	for (auto & slice : slices) {
+		n += slice->getRebuildCount();
+	}
+	for (auto & mask : masks) {
+		n += mask->getRebuildCount();
+	}
+	return n;
+}
+
+//--------------------------------------------------------------
+MemoryUsage Screen::getMemoryUsage() const {
+	MemoryUsage usage;
+	usage.gpu[MEMORY_FBOS] += getGpuBytes(fbo, samples);
+	usage.cpu[MEMORY_TEXTURES] += maskCoverage.getTotalBytes();
+	usage.gpu[MEMORY_TEXTURES] += getGpuBytes(maskTexture);
+	usage.cpu[MEMORY_SCRATCH] += rasterizer.getMemoryUsage() + distanceField.getMemoryUsage()
+		+ getCapacityBytes(maskState) + getCapacityBytes(selectedElements)
+		+ getCapacityBytes(pickState) + getCapacityBytes(pickBounds) + getCapacityBytes(pickCandidates);
+	usage.cpu[MEMORY_HANDLES] += slicePickGrid.getMemoryUsage() + maskPickGrid.getMemoryUsage()
+		+ getCapacityBytes(slicePickState) + getCapacityBytes(maskPickState);
+	for (auto & slice : slices) {
+		usage += slice->getMemoryUsage();
+	}
+	for (auto & mask : masks) {
+		usage += mask->getMemoryUsage();
+	}
+	return usage;
+}
+
+//--------------------------------------------------------------
+void Screen::compact() {
+	for (auto & slice : slices) {
+		slice->compact();
+	}
+	for (auto & mask : masks) {
+		mask->compact();
+	}
+	rasterizer.compact();
+	distanceField.compact();
+	maskState.shrink_to_fit();
+	selectedElements.shrink_to_fit();
+	slicePickGrid.compact();
+	maskPickGrid.compact();
+	vector<PickState>().swap(pickState);
+	vector<ofRectangle>().swap(pickBounds);
+	vector<size_t>().swap(pickCandidates);
+}
+
+//--------------------------------------------------------------
+void Screen::get(ScreenData & data) {
+	data.uniqueId = uniqueId;
+	data.name = name;
+	data.enabled = enabled;
+	data.width = width;
+	data.height = height;
+	data.slices.resize(slices.size());
+	for (size_t i = 0; i < slices.size(); i++)
+		slices[i]->get(data.slices[i]);
+	data.masks.resize(masks.size());
+	for (size_t i = 0; i < masks.size(); i++)
+		masks[i]->get(data.masks[i]);
+}
+
+//--------------------------------------------------------------
+size_t Screen::merge(const ScreenData & previous, const ScreenData & next) {
+
+	size_t changes = 0;
+
+	if (!isScreenEqual(previous, next)) {
+		name = next.name;
+		enabled = next.enabled;
+		// Resizing reallocates the frame buffer
+		if (width != next.width)
+			width = next.width;
+		if (height != next.height)
+			height = next.height;
+		changes++;
+	}
+
+	// Items without an id can't be matched and are left out
+	unordered_map<UniqueId, const SliceData *> previousSlices;
+	for (auto & data : previous.slices) {
+		previousSlices[data.uniqueId] = &data;
+	}
+	for (auto & data : next.slices) {
+		if (!data.uniqueId.isValid())
+			continue;
+		auto it = previousSlices.find(data.uniqueId);
+		if (it != previousSlices.end()) {
+			bool equal = *it->second == data;
+			previousSlices.erase(it);
+			if (equal)
+				continue;
+		}
+		SlicePtr slice = getSlice(data.uniqueId);
+		if (slice)
+			slice->set(data, ofRectangle(0, 0, width, height));
+		else
+			addSlice(data);
+		changes++;
+	}
+	// Whatever is left was removed
+	for (auto & p : previousSlices) {
+		for (size_t i = 0; i < slices.size(); i++) {
+			if (slices[i]->uniqueId == p.first) {
+				removeSlice(i);
+				changes++;
+				break;
+			}
+		}
+	}
+
+	unordered_map<UniqueId, const MaskData *> previousMasks;
+	for (auto & data : previous.masks) {
+		previousMasks[data.uniqueId] = &data;
+	}
+	for (auto & data : next.masks) {
+		if (!data.uniqueId.isValid())
+			continue;
+		auto it = previousMasks.find(data.uniqueId);
+		if (it != previousMasks.end()) {
+			bool equal = *it->second == data;
+			previousMasks.erase(it);
+			if (equal)
+				continue;
+		}
+		MaskPtr mask = getMask(data.uniqueId);
+		if (mask)
+			mask->set(data, getScreenRect());
+		else
+			addMask(data);
+		changes++;
+	}
+	for (auto & p : previousMasks) {
+		for (auto it = masks.begin(); it != masks.end(); ++it) {
+			if ((*it)->uniqueId == p.first) {
+				maskIndex.erase(*it);
+				masks.erase(it);
+				changes++;
+				break;
+			}
+		}
+	}
+
+	return changes;
+}
+
 //--------------------------------------------------------------
 bool ofxMapper::Screen::grab(const glm::vec2 & p, float radius) {
 	return grabMask(p, radius) || grabSlice(p, radius);
@@ -411,10 +1005,20 @@ void Screen::resolutionChanged(int &) {
 	if (width <= 0 || height <= 0)
 		return;
 
-	fbo.allocate(width, height, GL_RGB, samples);
-	fbo.begin();
-	ofClear(ofColor::black);
-	fbo.end();
+	// Atlas is reallocated by the mapper on its next update
+	if (allocationDeferred) {
+		allocationPending = true;
+	}
+	else if (!atlas && (!direct || isFboRequired())) {
+		fbo.allocate(width, height, GL_RGB, samples);
+		Profiler::count(COUNTER_ALLOCATIONS);
+		fbo.begin();
+		ofClear(ofColor::black);
+		fbo.end();
+	}
+	else {
+		fbo.clear();
+	}
 
     ofRectangle screenRect = getScreenRect();
     for (MaskPtr mask : masks) {
@@ -3,6 +3,9 @@
 #include "ofMain.h"
 #include "Slice.h"
 #include "Mask.h"
+#include "ScanlineRasterizer.h"
+#include "DistanceField.h"
+#include "SpatialGrid.h"
 
 namespace ofxMapper {
 
@@ -16,20 +19,40 @@ namespace ofxMapper {
 		ofRectangle getScreenSize();
 		glm::vec2 getScreenPos();
 		void update(ofTexture & inputTexture);
+		// Draw slices and masks to the current render target
+		void render(ofTexture & inputTexture);
+		// Frame buffer is not allocated while the screen is rendered to an atlas
 		const ofFbo & getFbo() const;
+		bool isInAtlas() const;
+		ofRectangle getAtlasRect() const;
 
 		void draw();
 		void draw(const ofRectangle & rect);
+		// Render slices and masks straight to rect on the current target, bypassing the frame buffer
+		void drawDirect(ofTexture & inputTexture);
+		void drawDirect(ofTexture & inputTexture, const ofRectangle & rect);
+
+		// Keep rendering to the frame buffer in direct mode, e.g. when using getFbo()
+		void setFboRequired(bool required);
+		bool isFboRequired() const;
+
+		// Color lookup applied to all slices without their own lut
+		bool loadColorLut(string filePath);
+		void setColorLut(ColorLutPtr lut);
+		ColorLutPtr getColorLut() const;
 
 		// Slices
 		vector<SlicePtr> & getSlices();
 		size_t getNumSlices() const;
 		SlicePtr getSlice(size_t sliceIndex);
+		SlicePtr getSlice(const UniqueId & uniqueId);
 		SlicePtr getSlice(string uniqueId);
 		SlicePtr addSlice(float width, float height);
         SlicePtr addSlice(float x, float y, float width, float height);
 		SlicePtr addSlice(string name, const ofRectangle & inputRect);
 		SlicePtr addSlice(string name, const ofRectangle & inputRect, const ofRectangle & outputRect);
+		// Geometry is built by the next flush()
+		SlicePtr addSlice(const SliceData & data);
 		void removeSlice(size_t sliceIndex);
 		
 		void deselectSlices();
@@ -45,30 +68,65 @@ namespace ofxMapper {
 		void dragSlice(const glm::vec2 & delta);
 		void releaseSlice();
 
+		// Rubber band and lasso selection of slice handles, across slices in edit mode
+		size_t selectHandles(const ofRectangle & rect, bool add = false);
+		size_t selectHandles(const ofPolyline & lasso, bool add = false);
+		void deselectHandles();
+		size_t getNumSelectedHandles();
+		ofRectangle getSelectedHandleBounds();
+		// Bulk edits of the selected handles, rebuilding each slice once
+		void transformSelectedHandles(const glm::mat3 & m);
+		void translateSelectedHandles(const glm::vec2 & delta);
+		void scaleSelectedHandles(const glm::vec2 & scale, const glm::vec2 & origin);
+		void rotateSelectedHandles(float radians, const glm::vec2 & origin);
+		// Map the corners of the selection bounds onto dst, top left first and clockwise
+		void warpSelectedHandles(const glm::vec2 dst[4]);
+
 		// Masks
 		vector<MaskPtr> & getMasks();
 		size_t getNumMasks() const;
 		MaskPtr getMask(size_t maskIndex);
+		MaskPtr getMask(const UniqueId & uniqueId);
 		MaskPtr getMask(string uniqueId);
 		MaskPtr addMask(string name);
+		MaskPtr addMask(const MaskData & data);
 		void removeMaskSelected();
 		void deselectMasks();
 		bool grabMask(const glm::vec2 & p, float radius);
 		void moveMask(const glm::vec2 & delta);
 		void dragMask(const glm::vec2 & delta);
 		void releaseMask();
+		// Union of all enabled masks, rasterized when a mask changes. 255 is fully masked.
+		const ofPixels & getMaskCoverage();
+		void updateMaskCoverage();
 
 		// Handles
 		enum { HANDLE_SQUARE, HANDLE_CIRCLE };
 		void drawHandles(int handleSize = 10, int handleType = HANDLE_SQUARE);
 
+		// Rebuild slices and masks edited since the last flush
+		void flush();
+		unsigned int getRebuildCount() const;
+
+		// Bytes held by the frame buffer, mask coverage and all slices and masks. Per slice
+		// and mask, see their getMemoryUsage().
+		MemoryUsage getMemoryUsage() const;
+		// Shrink slices, masks and scratch buffers to fit
+		void compact();
+
+		// Copy settings, slices and masks out
+		void get(ScreenData & data);
+		// Apply what changed from previous to next, matching slices and masks by uniqueId.
+		// Anything unchanged is left alone with its geometry. Returns the number of changes.
+		size_t merge(const ScreenData & previous, const ScreenData & next);
+
 		// Interaction
 		bool grab(const glm::vec2 & p, float radius);
 		void drag(const glm::vec2 & delta);
 		void release();
 
 		// Parameters
-		string uniqueId;
+		UniqueId uniqueId;
 		ofParameter<string> name = { "Name:", "" };
 		ofParameter<int> posX = { "X", 0, 0, 7680 };
 		ofParameter<int> posY = { "Y", 0, 0, 7680 };
@@ -84,14 +142,70 @@ namespace ofxMapper {
 	private:
 
         friend class Mapper;
+        friend class ScreenAtlas;
+        friend class CompositionLoader;
         Screen(int x, int y, int width, int height);
 		Screen(int width, int height);
+		// Without allocating, no GL calls are made until allocate(), so the screen can be
+		// built on another thread
+		Screen(int x, int y, int width, int height, bool allocate);
+		void allocate();
+		// In direct mode the frame buffer is only kept if required, see isFboRequired()
+		void setDirect(bool direct);
 
         void resolutionChanged(int &);
+		void setAtlas(const ofFbo * atlas, const ofRectangle & atlasRect);
 
 		ofFbo fbo;
+		bool fboRequired = false;
+		bool direct = false;
+		bool allocationDeferred = false;
+		bool allocationPending = false;
+		const ofFbo * atlas = NULL;
+		ofRectangle atlasRect;
+		ColorLutPtr colorLut;
 		vector<SlicePtr> slices;
 		vector<MaskPtr> masks;
+		UniqueIdIndex<Slice> sliceIndex;
+		UniqueIdIndex<Mask> maskIndex;
+
+		struct MaskState {
+			const Mask * mask;
+			unsigned int revision;
+			bool enabled;
+			bool operator==(const MaskState & m) const {
+				return mask == m.mask && revision == m.revision && enabled == m.enabled;
+			}
+		};
+		vector<MaskState> maskState;
+		ofPixels maskCoverage;
+		ofTexture maskTexture;
+		bool maskTextureEmpty = true;
+		ScanlineRasterizer rasterizer;
+		DistanceField distanceField;
+
+		// Slice and mask bounds indexed by position for grabSlice() and grabMask(), rebuilt
+		// when an element is added, removed or rebuilt
+		struct PickState {
+			const Element * element;
+			UniqueId uniqueId;
+			unsigned int revision;
+			bool operator==(const PickState & s) const {
+				return element == s.element && uniqueId == s.uniqueId && revision == s.revision;
+			}
+		};
+		void updateSlicePickGrid();
+		void updateMaskPickGrid();
+		void buildPickGrid(SpatialGrid & grid);
+		// Sorted positions of elements whose bounds are within radius of p
+		const vector<size_t> & queryPickGrid(const SpatialGrid & grid, const glm::vec2 & p, float radius);
+		vector<PickState> slicePickState;
+		vector<PickState> maskPickState;
+		SpatialGrid slicePickGrid;
+		SpatialGrid maskPickGrid;
+		vector<PickState> pickState;
+		vector<ofRectangle> pickBounds;
+		vector<size_t> pickCandidates;
 
 		vector<ElementPtr> selectedElements;
 	};
@@ -0,0 +1,154 @@
+#include "ScreenAtlas.h"
+#include "Profiler.h"
+
+using namespace ofxMapper;
+
+int ScreenAtlas::padding = 2;
+
+//--------------------------------------------------------------
+bool RectPacker::pack(const vector<glm::vec2> & sizes, float binWidth, float maxHeight, float padding, vector<ofRectangle> & rects, glm::vec2 & binSize) {
+
+	// Tallest first, so each shelf wastes little height
+	vector<size_t> order(sizes.size());
+	for (size_t i = 0; i < order.size(); i++)
+		order[i] = i;
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+		return sizes[a].y > sizes[b].y;
+	});
+
+	rects.resize(sizes.size());
+	binSize = glm::vec2(0, 0);
+
+	float x = 0;
+	float y = 0;
+	float shelfHeight = 0;
+
+	for (size_t i : order) {
+		const glm::vec2 & s = sizes[i];
+		if (s.x > binWidth)
+			return false;
+		if (x > 0 && x + s.x > binWidth) {
+			x = 0;
+			y += shelfHeight + padding;
+			shelfHeight = 0;
+		}
+		rects[i].set(x, y, s.x, s.y);
+		x += s.x + padding;
+		shelfHeight = std::max(shelfHeight, s.y);
+		binSize.x = std::max(binSize.x, rects[i].getRight());
+		binSize.y = std::max(binSize.y, rects[i].getBottom());
+	}
+	return binSize.y <= maxHeight;
+}
+
+//--------------------------------------------------------------
+bool RectPacker::pack(const vector<glm::vec2> & sizes, float maxSize, float padding, vector<ofRectangle> & rects, glm::vec2 & binSize) {
+	float area = 0;
+	float maxWidth = 0;
+	for (auto & s : sizes) {
+		area += (s.x + padding) * (s.y + padding);
+		maxWidth = std::max(maxWidth, s.x);
+	}
+	float binWidth = std::min(maxSize, std::max(maxWidth, ceilf(sqrtf(area))));
+	if (pack(sizes, binWidth, maxSize, padding, rects, binSize))
+		return true;
+	return pack(sizes, maxSize, maxSize, padding, rects, binSize);
+}
+
+//--------------------------------------------------------------
+bool ScreenAtlas::update(vector<ScreenPtr> & screens) {
+
+	vector<Entry> current;
+	current.reserve(screens.size());
+	for (auto & screen : screens) {
+		current.push_back({ screen.get(), screen->width, screen->height, screen->samples });
+	}
+	if (current == layout && fbo.isAllocated())
+		return true;
+	// Don't query and pack again every frame for screens already known not to fit
+	if (current.empty() || current == failedLayout) {
+		if (fbo.isAllocated())
+			clear(screens);
+		return false;
+	}
+
+	vector<glm::vec2> sizes;
+	int samples = 0;
+	for (auto & e : current) {
+		sizes.push_back(glm::vec2(e.width, e.height));
+		samples = std::max(samples, e.samples);
+	}
+
+	GLint maxSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+
+	glm::vec2 binSize;
+	if (!RectPacker::pack(sizes, maxSize, padding, rects, binSize)) {
+		ofLogWarning("ofxMapper") << "Screens don't fit in a " << maxSize << "x" << maxSize << " atlas";
+		clear(screens);
+		failedLayout = current;
+		return false;
+	}
+	failedLayout.clear();
+
+	fbo.allocate(binSize.x, binSize.y, GL_RGB, samples);
+	Profiler::count(COUNTER_ALLOCATIONS);
+	fbo.begin();
+	ofClear(ofColor::black);
+	fbo.end();
+
+	for (size_t i = 0; i < screens.size(); i++) {
+		screens[i]->setAtlas(&fbo, rects[i]);
+	}
+	layout = current;
+
+	return true;
+}
+
+//--------------------------------------------------------------
+void ScreenAtlas::render(vector<ScreenPtr> & screens, ofTexture & inputTexture) {
+
+	fbo.begin();
+	ofClear(0);
+
+	for (size_t i = 0; i < screens.size() && i < rects.size(); i++) {
+		const ofRectangle & r = rects[i];
+		ofPushView();
+		ofViewport(r);
+		ofSetupScreenPerspective(r.width, r.height);
+		screens[i]->render(inputTexture);
+		ofPopView();
+	}
+
+	fbo.end();
+}
+
+//--------------------------------------------------------------
+void ScreenAtlas::clear(vector<ScreenPtr> & screens) {
+	for (auto & screen : screens) {
+		screen->setAtlas(NULL, ofRectangle());
+	}
+	layout.clear();
+	rects.clear();
+	fbo.clear();
+}
+
+//--------------------------------------------------------------
+const ofFbo & ScreenAtlas::getFbo() const {
+	return fbo;
+}
+
+//--------------------------------------------------------------
+bool ScreenAtlas::isAllocated() const {
+	return fbo.isAllocated();
+}
+
+//--------------------------------------------------------------
+void ScreenAtlas::getMemoryUsage(MemoryUsage & usage) const {
+	int samples = 0;
+	for (auto & e : layout) {
+		samples = std::max(samples, e.samples);
+	}
+	usage.gpu[MEMORY_FBOS] += getGpuBytes(fbo, samples);
+	usage.cpu[MEMORY_SCRATCH] += getCapacityBytes(layout) + getCapacityBytes(rects);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Screen.h"
+
+// Shelf packer for placing rectangles in a single bin
+class RectPacker {
+public:
+	// Pack sizes into a bin of the given width. Fails if the packed height exceeds maxHeight.
+	static bool pack(const vector<glm::vec2> & sizes, float binWidth, float maxHeight, float padding, vector<ofRectangle> & rects, glm::vec2 & binSize);
+	// Pack sizes into the smallest square-ish bin not larger than maxSize
+	static bool pack(const vector<glm::vec2> & sizes, float maxSize, float padding, vector<ofRectangle> & rects, glm::vec2 & binSize);
+};
+
+namespace ofxMapper {
+
+	// All screens packed into one frame buffer, each rendered to its own viewport
+	class ScreenAtlas {
+	public:
+		// Repack and reallocate if screens were added, removed or resized. Returns false if screens don't fit.
+		bool update(vector<ScreenPtr> & screens);
+		void render(vector<ScreenPtr> & screens, ofTexture & inputTexture);
+		// Detach screens and release the frame buffer
+		void clear(vector<ScreenPtr> & screens);
+
+		const ofFbo & getFbo() const;
+		bool isAllocated() const;
+		void getMemoryUsage(MemoryUsage & usage) const;
+
+		static int padding;
+
+	private:
+		struct Entry {
+			Screen * screen;
+			int width;
+			int height;
+			int samples;
+			bool operator==(const Entry & e) const {
+				return screen == e.screen && width == e.width && height == e.height && samples == e.samples;
+			}
+		};
+
+		vector<Entry> layout;
+		// Last layout that didn't fit, retried once the screens change
+		vector<Entry> failedLayout;
+		vector<ofRectangle> rects;
+		ofFbo fbo;
+	};
+}
@@ -1,10 +1,11 @@
 #include "Slice.h"
+#include "Profiler.h"
 
 using namespace ofxMapper;
 
 //--------------------------------------------------------------
 Slice::Slice(float x, float y, float width, float height) {
-	uniqueId = ofToString((uint64_t)ofRandom(9999999999999));
+	uniqueId = UniqueId::create();
 
 	warper = &linearWarper;
 
@@ -17,8 +18,6 @@ Slice::Slice(float x, float y, float width, float height) {
 
 	ofRectangle inputRect(x, y, width, height);
 	setInputRect(inputRect);
-	bezierWarper.setInputRect(inputRect);
-	linearWarper.setInputRect(inputRect);
 }
 
 //--------------------------------------------------------------
@@ -48,8 +47,8 @@ void Slice::setVertices(vector<glm::vec2>& v, size_t controlWidth, size_t contro
     vertices = shared_ptr<Vertices>(new Vertices(controlWidth, controlHeight));
 	std::copy(v.begin(), v.end(), vertices->data);
 
-	linearWarper.setVertices(vertices);
-    bezierWarper.setVertices(vertices);
+	// Only the active warper is built, the other one when switching modes
+	buildWarper();
 
 	updateHandles();
 }
@@ -63,6 +62,16 @@ void Slice::createVertices(const ofRectangle & rect) {
 //--------------------------------------------------------------
 void ofxMapper::Slice::createVertices(const glm::vec2 & topLeft, const glm::vec2 & topRight, const glm::vec2 & bottomRight, const glm::vec2 & bottomLeft) {
 
+	makeVertices(topLeft, topRight, bottomRight, bottomLeft);
+
+	buildWarper();
+
+	updateHandles();
+}
+
+//--------------------------------------------------------------
+void Slice::makeVertices(const glm::vec2 & topLeft, const glm::vec2 & topRight, const glm::vec2 & bottomRight, const glm::vec2 & bottomLeft) {
+
 	vertices = shared_ptr<Vertices>(new Vertices(4, 4));
 	glm::vec2 * v = vertices->data;
 
@@ -80,11 +89,89 @@ void ofxMapper::Slice::createVertices(const glm::vec2 & topLeft, const glm::vec2
 			v[y * vertices->width + x] = glm::mix(y0, y1, dx);
 		}
 	}
+}
+
+//--------------------------------------------------------------
+void Slice::set(const SliceData & data, const ofRectangle & outputRect) {
+	if (data.uniqueId.isValid())
+		uniqueId = data.uniqueId;
+	name = data.name;
+	enabled = data.enabled;
+	softEdgeEnabled = data.softEdgeEnabled;
+	softEdge.power = data.softEdgePower;
+	softEdge.luminance = data.softEdgeLuminance;
+	softEdge.gamma = data.softEdgeGamma;
+
+	inputX.setWithoutEventNotifications(data.inputRect.x);
+	inputY.setWithoutEventNotifications(data.inputRect.y);
+	inputWidth.setWithoutEventNotifications(data.inputRect.width);
+	inputHeight.setWithoutEventNotifications(data.inputRect.height);
+
+	bezierEnabled.setWithoutEventNotifications(data.bezierEnabled);
+	Warper * previous = warper;
+	warper = bezierEnabled ? (Warper*)&bezierWarper : (Warper*)&linearWarper;
+	if (previous != warper)
+		previous->clear();
+
+	size_t w = data.controlWidth;
+	size_t h = data.controlHeight;
+	if (w >= 4 && h >= 4 && data.vertices.size() == w * h) {
+		vertices = shared_ptr<Vertices>(new Vertices(w, h));
+		std::copy(data.vertices.begin(), data.vertices.end(), vertices->data);
+	}
+	else {
+		makeVertices(outputRect.getTopLeft(), outputRect.getTopRight(), outputRect.getBottomRight(), outputRect.getBottomLeft());
+	}
 
-	linearWarper.setVertices(vertices);
-	bezierWarper.setVertices(vertices);
+	handles.clear();
+	invalidateHandleIndex();
+	buildPending = true;
+}
+
+//--------------------------------------------------------------
+void Slice::get(SliceData & data) {
+	data.uniqueId = uniqueId;
+	data.name = name;
+	data.enabled = enabled;
+	data.inputRect = getInputRect();
+	data.bezierEnabled = bezierEnabled;
+	data.softEdgeEnabled = softEdgeEnabled;
+	data.softEdgePower = softEdge.power;
+	data.softEdgeLuminance = softEdge.luminance;
+	data.softEdgeGamma = softEdge.gamma;
+	if (vertices) {
+		data.controlWidth = vertices->width;
+		data.controlHeight = vertices->height;
+		data.vertices.assign(vertices->data, vertices->data + vertices->width * vertices->height);
+	}
+	else {
+		data.controlWidth = 0;
+		data.controlHeight = 0;
+		data.vertices.clear();
+	}
+}
 
+//--------------------------------------------------------------
+void Slice::build() {
+	TraceScope trace("Slice::build", "geometry");
+	ofRectangle inputRect = getInputRect();
+	warper->setVertices(vertices);
+	warper->setInputRect(inputRect);
+	updateInputHandles();
 	updateHandles();
+
+	buildPending = false;
+	geometryDirty = false;
+	rebuildCount++;
+	Profiler::count(COUNTER_REBUILDS);
+}
+
+//--------------------------------------------------------------
+void Slice::buildWarper() {
+	TraceScope trace("Slice::buildWarper", "geometry");
+	warper->setVertices(vertices);
+	rebuildCount++;
+	Profiler::count(COUNTER_REBUILDS);
 }
 
 //--------------------------------------------------------------
@@ -104,13 +191,14 @@ size_t Slice::getControlHeight() {
 
 //--------------------------------------------------------------
 void Slice::subdivide(int cols, int rows) {
+	// Subdivision samples the patches, so they must be current
+	flush();
     if (bezierEnabled)
         vertices = bezierWarper.subdivide(cols, rows);
     else
         vertices = linearWarper.subdivide(cols, rows);
 
-    linearWarper.setVertices(vertices);
-    bezierWarper.setVertices(vertices);
+    buildWarper();
 
     updateHandles();
 }
@@ -123,7 +211,52 @@ void ofxMapper::Slice::reset() {
 
 //--------------------------------------------------------------
 void Slice::update() {
+	TraceScope trace("Slice::update", "geometry");
 	warper->updatePatches();
+	geometryDirty = false;
+	rebuildCount++;
+	Profiler::count(COUNTER_REBUILDS);
+}
+
+//--------------------------------------------------------------
+void Slice::flush() {
+	if (buildPending)
+		build();
+	else if (isDirty())
+		update();
+}
+
+//--------------------------------------------------------------
+bool Slice::isDirty() const {
+	return buildPending || geometryDirty || (bezierEnabled && bezierWarper.isDirty());
+}
+
+//--------------------------------------------------------------
+unsigned int Slice::getRebuildCount() const {
+	return rebuildCount;
+}
+
+//--------------------------------------------------------------
+MemoryUsage Slice::getMemoryUsage() const {
+	MemoryUsage usage;
+	if (vertices)
+		usage.cpu[MEMORY_CURVES] += vertices->width * vertices->height * sizeof(glm::vec2);
+	usage.cpu[MEMORY_HANDLES] += getHandleMemoryUsage() + getCapacityBytes(inputHandles);
+	usage.cpu[MEMORY_SCRATCH] += getCapacityBytes(transformIndices) + getCapacityBytes(transformPoints) + getCapacityBytes(blendRects);
+	bezierWarper.getMemoryUsage(usage);
+	linearWarper.getMemoryUsage(usage);
+	return usage;
+}
+
+//--------------------------------------------------------------
+void Slice::compact() {
+	compactHandles();
+	inputHandles.shrink_to_fit();
+	vector<size_t>().swap(transformIndices);
+	vector<glm::vec2>().swap(transformPoints);
+	blendRects.shrink_to_fit();
+	bezierWarper.compact();
+	linearWarper.compact();
 }
 
 //--------------------------------------------------------------
@@ -155,7 +288,14 @@ vector<RectHandle> & Slice::getInputHandles() {
 //--------------------------------------------------------------
 bool ofxMapper::Slice::grabInputHandle(const glm::vec2 & p, float radius) {
 	bool grabbed = false;
+	ofRectangle bounds(inputX - radius, inputY - radius, inputWidth + radius * 2, inputHeight + radius * 2);
+	bool near = bounds.inside(p.x, p.y);
 	for (auto & h : inputHandles) {
+		if (!near) {
+			h.selected = false;
+			h.dragging = false;
+			continue;
+		}
 		if (glm::distance(p, h.position) <= radius) {
 			grabbed = true;
 			h.selected = true;
@@ -265,15 +405,21 @@ glm::vec2 Slice::getCenter() {
 
 //--------------------------------------------------------------
 void Slice::draw() {
-    
+	draw(ColorLutPtr());
+}
+
+//--------------------------------------------------------------
+void Slice::draw(const ColorLutPtr & screenLut) {
+
+	ProfileScope scope(STAGE_SLICE_DRAW);
     const ofShader & shader = warper->getShader();
 
     shader.begin();
     softEdge.setUniforms(shader, getInputRect());
     if (colorEnabled)
-        colorCorrect.setUniforms(shader);
+        colorCorrect.setUniforms(shader, screenLut);
     else
-        colorCorrect.setUniformsZero(shader);
+        colorCorrect.setUniformsZero(shader, screenLut);
     shader.end();
 
     warper->drawMesh();
@@ -296,6 +442,21 @@ void ofxMapper::Slice::moveInput(const glm::vec2 & delta) {
 	inputY.set(inputY + delta.y); // trigger event
 }
 
+//--------------------------------------------------------------
+ofRectangle Slice::getBounds() const {
+	if (!vertices)
+		return ofRectangle();
+	size_t n = vertices->width * vertices->height;
+	const glm::vec2 * v = vertices->data;
+	glm::vec2 lo = v[0];
+	glm::vec2 hi = v[0];
+	for (size_t i = 1; i < n; i++) {
+		lo = glm::min(lo, v[i]);
+		hi = glm::max(hi, v[i]);
+	}
+	return ofRectangle(lo.x, lo.y, hi.x - lo.x, hi.y - lo.y);
+}
+
 //--------------------------------------------------------------
 bool Slice::select(const glm::vec2 & p) {
 	selected = warper->select(p);
@@ -309,7 +470,7 @@ void ofxMapper::Slice::move(const glm::vec2 & delta) {
 	for (int i = 0; i < n; i++) {
 		v[i] += delta;
 	}
-	update();
+	geometryDirty = true;
 	updateHandles();
 }
 
@@ -351,6 +512,7 @@ void Slice::updateHandles() {
 		}
 		rowIndex += gridCols;
 	}
+	invalidateHandleIndex();
 }
 
 //--------------------------------------------------------------
@@ -369,6 +531,13 @@ bool Slice::grabHandle(const glm::vec2 & p, float radius) {
 	return grabbed;
 }
 
+//--------------------------------------------------------------
+void Slice::deselectAllHandles() {
+	deselectHandles();
+	if (bezierEnabled)
+		bezierWarper.clearHandles();
+}
+
 //--------------------------------------------------------------
 void Slice::dragHandle(const glm::vec2 & delta) {
 	HasHandlesT<WarpHandle>::dragHandle(delta);
@@ -394,24 +563,89 @@ void Slice::moveHandle(WarpHandle & handle, const glm::vec2 & delta) {
 
 //--------------------------------------------------------------
 void Slice::notifyHandles() {
-	update();
+	geometryDirty = true;
+}
+
+//--------------------------------------------------------------
+bool Slice::transformSelectedHandles(const glm::mat3 & m) {
+	if (!vertices)
+		return false;
+
+	size_t w = vertices->width;
+	size_t h = vertices->height;
+	glm::vec2 * v = vertices->data;
+
+	size_t numSelected = getNumSelectedHandles();
+	if (numSelected == 0)
+		return false;
+
+	if (numSelected == handles.size()) {
+		// Whole slice, transform all vertices in place
+		VertexTransform::apply(m, v, w * h);
+	}
+	else {
+		// Gather selected vertices, and in bezier mode the surrounding controls
+		transformIndices.clear();
+		for (size_t i : getActiveHandles()) {
+			WarpHandle & handle = handles[i];
+			if (!handle.selected)
+				continue;
+			if (!bezierEnabled) {
+				transformIndices.push_back(handle.vertexIndex);
+				continue;
+			}
+			int col = handle.vertexIndex % w;
+			int row = handle.vertexIndex / w;
+			for (int y = std::max(0, row - 1); y <= std::min((int)h - 1, row + 1); y++) {
+				for (int x = std::max(0, col - 1); x <= std::min((int)w - 1, col + 1); x++) {
+					transformIndices.push_back(y * w + x);
+				}
+			}
+		}
+
+		transformPoints.resize(transformIndices.size());
+		for (size_t i = 0; i < transformIndices.size(); i++)
+			transformPoints[i] = v[transformIndices[i]];
+		VertexTransform::apply(m, transformPoints.data(), transformPoints.size());
+		for (size_t i = 0; i < transformIndices.size(); i++)
+			v[transformIndices[i]] = transformPoints[i];
+	}
+
+	for (size_t i : getActiveHandles()) {
+		if (handles[i].selected)
+			setHandlePosition(i, v[handles[i].vertexIndex]);
+	}
+	if (bezierEnabled)
+		bezierWarper.updateHandles(handles);
+
+	notifyHandles();
+	return true;
 }
 
 //--------------------------------------------------------------
 void Slice::clearBlendRects() {
-	softEdge.edgeTop = 0;
-	softEdge.edgeBottom = 0;
-	softEdge.edgeLeft = 0;
-	softEdge.edgeRight = 0;
+	softEdge.clearEdges();
     blendRects.clear();
 }
 
 //--------------------------------------------------------------
 bool Slice::addBlendRect(const ofRectangle & rect) {
-    if (rect.getLeft() == inputX)
-        softEdge.edgeLeft = rect.width / inputWidth;
-    if (rect.getRight() == inputX + inputWidth)
-        softEdge.edgeRight = rect.width / inputWidth;
+	float w = rect.width / inputWidth;
+	float h = rect.height / inputHeight;
+
+	// Overlap spanning more of the height than the width is a side-by-side neighbour
+	if (h >= w) {
+		if (rect.getLeft() == inputX)
+			softEdge.addEdge(SoftEdge::SIDE_LEFT, w);
+		if (rect.getRight() == inputX + inputWidth)
+			softEdge.addEdge(SoftEdge::SIDE_RIGHT, w);
+	}
+	else {
+		if (rect.getTop() == inputY)
+			softEdge.addEdge(SoftEdge::SIDE_TOP, h);
+		if (rect.getBottom() == inputY + inputHeight)
+			softEdge.addEdge(SoftEdge::SIDE_BOTTOM, h);
+	}
 
     blendRects.push_back(rect);
     return true;
@@ -441,12 +675,16 @@ void Slice::inputRectChanged(int &) {
 
 //--------------------------------------------------------------
 void Slice::bezierChanged(bool &) {
+    Warper * previous = warper;
     if (bezierEnabled)
         warper = &bezierWarper;
     else
         warper = &linearWarper;
 
-    warper->updatePatches();
+    if (previous != warper)
+        previous->clear();
+    if (vertices)
+        buildWarper();
     
     ofRectangle inputRect = getInputRect();
     warper->setInputRect(inputRect);
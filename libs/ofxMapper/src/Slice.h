@@ -9,6 +9,8 @@
 #include "LinearWarper.h"
 #include "SoftEdge.h"
 #include "ColorCorrect.h"
+#include "VertexTransform.h"
+#include "MapperData.h"
 
 class RectHandle : public DragHandle {
 public:
@@ -52,11 +54,20 @@ namespace ofxMapper {
 		void subdivide(int cols, int rows);
 		void reset();
 
+		// Take all settings and vertices from data. Geometry is built by the next flush(),
+		// with the default grid over outputRect if data has no vertices.
+		void set(const SliceData & data, const ofRectangle & outputRect);
+		// Copy all settings and vertices out
+		void get(SliceData & data);
+
 		// Draw
 		virtual void draw();
+		void draw(const ColorLutPtr & screenLut);
 		virtual void drawOutline();
 
 		virtual glm::vec2 getCenter();
+		// Bounds of the control vertices, which hold the outline and all handles
+		ofRectangle getBounds() const;
 
 		virtual bool select(const glm::vec2 & p);
 		virtual void move(const glm::vec2 & delta);
@@ -64,17 +75,32 @@ namespace ofxMapper {
 
 		// Warper
 		void update();
+		// Rebuild geometry if handle edits marked it dirty
+		void flush();
+		bool isDirty() const;
+		// Number of geometry rebuilds since creation
+		unsigned int getRebuildCount() const;
 		Warper * getWarper();
 		BezierWarper & getBezierWarper();
 
+		// Bytes held by vertices, both warpers and handles. Color and blend luts are shared
+		// between slices and counted by Mapper::getMemoryUsage().
+		MemoryUsage getMemoryUsage() const;
+		// Shrink buffers to fit, keeping the geometry
+		void compact();
+
 
 		// Handles
 		void updateHandles();
 		bool grabHandle(const glm::vec2 & p, float radius);
+		// Deselect warp and bezier handles, as a grabHandle() that misses does
+		void deselectAllHandles();
 		void dragHandle(const glm::vec2 & delta);
 		bool moveHandle(const glm::vec2 & delta);
 		void moveHandle(WarpHandle & handle, const glm::vec2 & delta);
 		void notifyHandles();
+		// Transform selected handles, with their bezier controls, and mark the slice dirty once
+		bool transformSelectedHandles(const glm::mat3 & m);
 
 		using HasHandlesT<WarpHandle>::grabHandle;
 		using HasHandlesT<WarpHandle>::moveHandle;
@@ -114,9 +140,19 @@ namespace ofxMapper {
 		void inputRectChanged(int&);
 		void bezierChanged(bool&);
 
+		void makeVertices(const glm::vec2 & topLeft, const glm::vec2 & topRight, const glm::vec2 & bottomRight, const glm::vec2 & bottomLeft);
+		void build();
+		// Rebuild the active warper from the vertices now, counted like build()
+		void buildWarper();
+
 		vector<RectHandle> inputHandles;
 
 		VerticesPtr vertices;
+		bool geometryDirty = false;
+		bool buildPending = false;
+		unsigned int rebuildCount = 0;
+		vector<size_t> transformIndices;
+		vector<glm::vec2> transformPoints;
 
 		Warper * warper;
 		BezierWarper bezierWarper;
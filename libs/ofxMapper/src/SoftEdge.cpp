@@ -1,4 +1,7 @@
 #include "SoftEdge.h"
+#include "Profiler.h"
+#include <tuple>
+#include <mutex>
 
 #define STR(a) #a
 
@@ -11,32 +14,37 @@ static string softEdgeFrag =
 STR(
 uniform vec2 pos;       // Position offset of rendered texture-subsection. Typical (0,0)
 uniform vec2 size;      // Size of rendered texture or texture sub-section.
-uniform float edgeLeft; // Left edge procentage. Range 0-1
-uniform float edgeRight;// Right edge procentage. Range 0-1
-uniform float edgeTop;  // Top edge procentage. Range 0-1
-uniform float edgeBottom;// Bottom edge procentage. Range 0-1
-uniform float p;        // Blend curve. Typical 1-3
-uniform float a;        // Blend center brightness. Default 0.5
-uniform float gamma;    // Gamma. Blend region inverse-gamma to compensate for projectors own gamma. Default 1
+uniform vec4 edges;     // Left, top, right and bottom edge procentage. Range 0-1
+uniform sampler2DRect blendLut; // Blend function incl. gamma, indexed by blend position
+uniform float blendLutSize;     // Number of entries in blendLut
+uniform float blendExact;       // Evaluate the blend function instead of the lut
+uniform vec3 blendParams;       // Power, luminance and gamma of the blend function
+
+float blendCurve(float x) {
+	float f = x < 0.5 ? blendParams.y * pow(2.0 * x, blendParams.x) : 1.0 - (1.0 - blendParams.y) * pow(2.0 * (1.0 - x), blendParams.x);
+	return pow(f, 1.0 / max(blendParams.z, 0.000001));
+}
 
 vec4 softEdge(vec4 sample, vec2 uv) {
 
-	// Calculate the blend position (x)
-	float x = 1.0;
-	if (uv.x < edgeLeft)
-		x = uv.x / edgeLeft;
-	if (uv.x > 1.0 - edgeRight)
-		x = (1.0 - uv.x) / edgeRight;
+	// Calculate the blend position of all four edges at once. Edges of zero width don't blend.
+	vec4 ramp = clamp(vec4(uv, 1.0 - uv) / max(edges, 0.000001), 0.0, 1.0);
+	ramp = mix(vec4(1.0), ramp, step(0.000001, edges));
+
+	// Horizontal (x) and vertical (y) blend position
+	vec2 x = min(ramp.xy, ramp.zw);
 
-	// Calculate blend function
-	float f = 1.0;
-	if (x < 0.5)
-		f = a * pow(2.0 * x, p);
-	else
-		f = 1.0 - (1.0 - a) * pow(2.0 * (1.0 - x), p);
+	// Look up blend function brightness
+	float f;
+	if (blendExact > 0.5) {
+		f = blendCurve(x.x) * blendCurve(x.y);
+	} else {
+		x = x * (blendLutSize - 1.0) + 0.5;
+		f = texture2DRect(blendLut, vec2(x.x, 0.5)).r * texture2DRect(blendLut, vec2(x.y, 0.5)).r;
+	}
 
 	// Apply blend function brightness
-	sample.rgb = sample.rgb * pow(f, gamma);
+	sample.rgb = sample.rgb * f;
 
 	return sample;
 }
@@ -53,20 +61,154 @@ void main() {
 }
 );
 
+//--------------------------------------------------------------
+SoftEdge::SoftEdge() {
+	power.addListener(this, &SoftEdge::blendChanged);
+	luminance.addListener(this, &SoftEdge::blendChanged);
+	gamma.addListener(this, &SoftEdge::blendChanged);
+
+	blendLut = BlendLut::get(power, luminance, gamma);
+}
+
+//--------------------------------------------------------------
+SoftEdge::~SoftEdge() {
+	power.removeListener(this, &SoftEdge::blendChanged);
+	luminance.removeListener(this, &SoftEdge::blendChanged);
+	gamma.removeListener(this, &SoftEdge::blendChanged);
+}
+
+//--------------------------------------------------------------
 string SoftEdge::getShaderSource() {
 	return softEdgeFrag;
 }
 
+//--------------------------------------------------------------
 void SoftEdge::setUniforms(const ofShader & shader, const ofRectangle & inputRect) {
 	shader.setUniform2f("pos", inputRect.position);
 	shader.setUniform2f("size", inputRect.width, inputRect.height);
-	shader.setUniform1f("edgeTop", edgeTop);
-	shader.setUniform1f("edgeBottom", edgeBottom);
-	shader.setUniform1f("edgeLeft", edgeLeft);
-	shader.setUniform1f("edgeRight", edgeRight);
-	shader.setUniform1f("p", power);
-	shader.setUniform1f("a", luminance);
-	shader.setUniform1f("gamma", 1.f / gamma);
+	ofxMapper::Profiler::count(ofxMapper::COUNTER_UNIFORMS, 2);
+	setUniforms(shader);
+}
+
+//--------------------------------------------------------------
+void SoftEdge::setUniforms(const ofShader & shader) {
+	shader.setUniform4f("edges", getEdges());
+	shader.setUniformTexture("blendLut", blendLut->getTexture(), 1);
+	shader.setUniform1f("blendLutSize", BlendLut::size);
+	shader.setUniform1f("blendExact", blendLut->isTabulated() ? 0 : 1);
+	shader.setUniform3f("blendParams", blendLut->getPower(), blendLut->getLuminance(), blendLut->getGamma());
 	shader.setUniform1f("black", 0);
 	shader.setUniform3f("gain", 1.f, 1.0f, 1.f);
+	ofxMapper::Profiler::count(ofxMapper::COUNTER_UNIFORMS, 7);
+}
+
+//--------------------------------------------------------------
+float SoftEdge::getBlend(float x) const {
+	return blendLut->lookup(x);
+}
+
+//--------------------------------------------------------------
+float SoftEdge::getBlend(const glm::vec2 & uv) const {
+	glm::vec4 edges = getEdges();
+	glm::vec4 d(uv.x, uv.y, 1.f - uv.x, 1.f - uv.y);
+	glm::vec4 ramp(1.f);
+	for (int i = 0; i < 4; i++) {
+		if (edges[i] > 0.000001f)
+			ramp[i] = ofClamp(d[i] / edges[i], 0.f, 1.f);
+	}
+	return getBlend(std::min(ramp.x, ramp.z)) * getBlend(std::min(ramp.y, ramp.w));
+}
+
+//--------------------------------------------------------------
+glm::vec4 SoftEdge::getEdges() const {
+	return glm::vec4(edgeLeft, edgeTop, edgeRight, edgeBottom);
+}
+
+//--------------------------------------------------------------
+void SoftEdge::clearEdges() {
+	edgeLeft = 0;
+	edgeTop = 0;
+	edgeRight = 0;
+	edgeBottom = 0;
+}
+
+//--------------------------------------------------------------
+void SoftEdge::addEdge(Side side, float width) {
+	ofParameter<float> * edge[] = { &edgeLeft, &edgeTop, &edgeRight, &edgeBottom };
+	if (width > edge[side]->get())
+		edge[side]->set(width);
+}
+
+//--------------------------------------------------------------
+const BlendLutPtr & SoftEdge::getBlendLut() const {
+	return blendLut;
+}
+
+//--------------------------------------------------------------
+void SoftEdge::blendChanged(float &) {
+	blendLut = BlendLut::get(power, luminance, gamma);
+}
+
+//--------------------------------------------------------------
+BlendLutPtr BlendLut::get(float power, float luminance, float gamma) {
+	// Slices are built on loader threads while the render thread edits live ones
+	static std::mutex mutex;
+	static map<std::tuple<float, float, float>, weak_ptr<BlendLut>> cache;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	auto key = std::make_tuple(power, luminance, gamma);
+	BlendLutPtr lut = cache[key].lock();
+	if (!lut) {
+		for (auto it = cache.begin(); it != cache.end(); ) {
+			if (it->second.expired() && it->first != key)
+				it = cache.erase(it);
+			else
+				++it;
+		}
+		lut = BlendLutPtr(new BlendLut(power, luminance, gamma));
+		cache[key] = lut;
+	}
+	return lut;
+}
+
+//--------------------------------------------------------------
+float BlendLut::getCurve(float x, float p, float a, float gamma) {
+	return BlendCurve::evaluate(x, p, a, gamma);
+}
+
+//--------------------------------------------------------------
+BlendLut::BlendLut(float power, float luminance, float gamma) : curve(power, luminance, gamma) {
+}
+
+//--------------------------------------------------------------
+float BlendLut::lookup(float x) const {
+	return curve.lookup(x);
+}
+
+//--------------------------------------------------------------
+const vector<float> & BlendLut::getValues() const {
+	return curve.getValues();
+}
+
+//--------------------------------------------------------------
+bool BlendLut::isTabulated() const {
+	return curve.isTabulated();
+}
+
+//--------------------------------------------------------------
+const ofTexture & BlendLut::getTexture() {
+	if (!texture.isAllocated()) {
+		texture.allocate(size, 1, GL_R32F, true);
+		ofxMapper::Profiler::count(ofxMapper::COUNTER_ALLOCATIONS);
+		texture.loadData(curve.getValues().data(), size, 1, GL_RED);
+		texture.setTextureWrap(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+		texture.setTextureMinMagFilter(GL_LINEAR, GL_LINEAR);
+	}
+	return texture;
+}
+
+//--------------------------------------------------------------
+void BlendLut::getMemoryUsage(ofxMapper::MemoryUsage & usage) const {
+	usage.cpu[ofxMapper::MEMORY_TEXTURES] += ofxMapper::getCapacityBytes(curve.getValues());
+	usage.gpu[ofxMapper::MEMORY_TEXTURES] += ofxMapper::getGpuBytes(texture);
 }
@@ -1,14 +1,36 @@
 #pragma once
 
 #include "ofMain.h"
+#include "MemoryUsage.h"
+#include "BlendCurve.h"
+
+class BlendLut;
+typedef shared_ptr<BlendLut> BlendLutPtr;
 
 class SoftEdge {
 public:
+	SoftEdge();
+	~SoftEdge();
+
 	static string getShaderSource();
 
 	void setUniforms(const ofShader & shader, const ofRectangle & inputRect);
     void setUniforms(const ofShader & shader);
 
+	// Edges, in the order left, top, right, bottom
+	enum Side { SIDE_LEFT, SIDE_TOP, SIDE_RIGHT, SIDE_BOTTOM };
+	glm::vec4 getEdges() const;
+	void clearEdges();
+	// Widen an edge to at least width (0-1)
+	void addEdge(Side side, float width);
+
+	// Blend brightness at blend position x (0-1), from the lookup table
+	float getBlend(float x) const;
+	// Blend brightness at normalized slice coordinate uv
+	float getBlend(const glm::vec2 & uv) const;
+
+	const BlendLutPtr & getBlendLut() const;
+
 	ofParameter<float> edgeLeft = { "Left", 0, 0, 1 };
 	ofParameter<float> edgeRight = { "Right", 0, 0, 1 };
 	ofParameter<float> edgeTop = { "Top", 0, 0, 1 };
@@ -19,6 +41,39 @@ public:
 	ofParameter<float> power = { "Power", 2, 0.1, 7 };
 	ofParameterGroup group = {"Soft Edge", gamma, luminance, power};
 
+private:
+	void blendChanged(float &);
+
+	BlendLutPtr blendLut;
 };
 
 typedef shared_ptr<SoftEdge> SoftEdgePtr;
+
+
+// Blend response table, shared between soft edges with equal power, luminance and gamma
+class BlendLut {
+public:
+	static const size_t size = BlendCurve::size;
+
+	static BlendLutPtr get(float power, float luminance, float gamma);
+
+	// Analytic blend response. Same as the curve stored in the table.
+	static float getCurve(float x, float power, float luminance, float gamma);
+
+	float lookup(float x) const;
+	const vector<float> & getValues() const;
+	// Curves the table can't follow are evaluated in the shader, see BlendCurve
+	bool isTabulated() const;
+	const ofTexture & getTexture();
+	void getMemoryUsage(ofxMapper::MemoryUsage & usage) const;
+
+	float getPower() const { return curve.getPower(); }
+	float getLuminance() const { return curve.getLuminance(); }
+	float getGamma() const { return curve.getGamma(); }
+
+private:
+	BlendLut(float power, float luminance, float gamma);
+
+	BlendCurve curve;
+	ofTexture texture;
+};
@@ -0,0 +1,130 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+
+//--------------------------------------------------------------
+void SpatialGrid::clear(float size) {
+	cells.clear();
+	count = 0;
+	cellSize = std::max(size, 0.0001f);
+	invCellSize = 1.f / cellSize;
+}
+
+//--------------------------------------------------------------
+float SpatialGrid::getCellSize(const std::vector<glm::vec2> & points, float minCellSize) {
+	if (points.empty())
+		return minCellSize;
+	glm::vec2 lo = points[0];
+	glm::vec2 hi = points[0];
+	for (auto & p : points) {
+		lo = glm::min(lo, p);
+		hi = glm::max(hi, p);
+	}
+	glm::vec2 size = hi - lo;
+	float area = std::max(size.x, minCellSize) * std::max(size.y, minCellSize);
+	return std::max(minCellSize, std::sqrt(area / points.size()));
+}
+
+//--------------------------------------------------------------
+int SpatialGrid::getCell(float v) const {
+	return (int)std::floor(v * invCellSize);
+}
+
+//--------------------------------------------------------------
+void SpatialGrid::insert(size_t id, const glm::vec2 & p) {
+	cells[getKey(getCell(p.x), getCell(p.y))].push_back(id);
+	count++;
+}
+
+//--------------------------------------------------------------
+void SpatialGrid::insert(size_t id, const glm::vec2 & min, const glm::vec2 & max) {
+	int x0 = getCell(min.x);
+	int y0 = getCell(min.y);
+	int x1 = getCell(max.x);
+	int y1 = getCell(max.y);
+	for (int y = y0; y <= y1; y++) {
+		for (int x = x0; x <= x1; x++) {
+			cells[getKey(x, y)].push_back(id);
+		}
+	}
+	count++;
+}
+
+//--------------------------------------------------------------
+void SpatialGrid::remove(size_t id, const glm::vec2 & p) {
+	auto it = cells.find(getKey(getCell(p.x), getCell(p.y)));
+	if (it == cells.end())
+		return;
+	auto & ids = it->second;
+	auto found = std::find(ids.begin(), ids.end(), id);
+	if (found == ids.end())
+		return;
+	*found = ids.back();
+	ids.pop_back();
+	if (ids.empty())
+		cells.erase(it);
+	count--;
+}
+
+//--------------------------------------------------------------
+void SpatialGrid::move(size_t id, const glm::vec2 & from, const glm::vec2 & to) {
+	if (getCell(from.x) == getCell(to.x) && getCell(from.y) == getCell(to.y))
+		return;
+	remove(id, from);
+	insert(id, to);
+}
+
+//--------------------------------------------------------------
+void SpatialGrid::query(const glm::vec2 & p, float radius, std::vector<size_t> & ids) const {
+	query(p - glm::vec2(radius), p + glm::vec2(radius), ids);
+}
+
+//--------------------------------------------------------------
+void SpatialGrid::query(const glm::vec2 & min, const glm::vec2 & max, std::vector<size_t> & ids) const {
+	int x0 = getCell(min.x);
+	int y0 = getCell(min.y);
+	int x1 = getCell(max.x);
+	int y1 = getCell(max.y);
+
+	// Large queries walk the occupied cells instead of the covered ones
+	if ((uint64_t)(x1 - x0 + 1) * (uint64_t)(y1 - y0 + 1) > cells.size()) {
+		for (auto & cell : cells) {
+			int x = (int)(uint32_t)(cell.first >> 32);
+			int y = (int)(uint32_t)(cell.first & 0xffffffff);
+			if (x >= x0 && x <= x1 && y >= y0 && y <= y1)
+				ids.insert(ids.end(), cell.second.begin(), cell.second.end());
+		}
+		return;
+	}
+
+	for (int y = y0; y <= y1; y++) {
+		for (int x = x0; x <= x1; x++) {
+			auto it = cells.find(getKey(x, y));
+			if (it != cells.end())
+				ids.insert(ids.end(), it->second.begin(), it->second.end());
+		}
+	}
+}
+
+//--------------------------------------------------------------
+size_t SpatialGrid::getMemoryUsage() const {
+	size_t n = cells.bucket_count() * sizeof(void *);
+	for (auto & cell : cells) {
+		n += sizeof(cell) + sizeof(void *) + cell.second.capacity() * sizeof(size_t);
+	}
+	return n;
+}
+
+//--------------------------------------------------------------
+void SpatialGrid::compact() {
+	for (auto it = cells.begin(); it != cells.end();) {
+		if (it->second.empty()) {
+			it = cells.erase(it);
+		}
+		else {
+			it->second.shrink_to_fit();
+			++it;
+		}
+	}
+	cells.rehash(0);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include "glm/glm.hpp"
+
+// Uniform grid hashing point or rect ids by cell. Queries return candidates from the
+// overlapping cells, callers do the exact distance test.
+class SpatialGrid {
+public:
+	void clear(float cellSize);
+
+	// Cell size giving roughly one point per cell over the points' bounds
+	static float getCellSize(const std::vector<glm::vec2> & points, float minCellSize = 1.f);
+
+	void insert(size_t id, const glm::vec2 & p);
+	// Rects go in every cell they overlap, so queries may return their ids more than once
+	void insert(size_t id, const glm::vec2 & min, const glm::vec2 & max);
+	void remove(size_t id, const glm::vec2 & p);
+	void move(size_t id, const glm::vec2 & from, const glm::vec2 & to);
+
+	void query(const glm::vec2 & p, float radius, std::vector<size_t> & ids) const;
+	void query(const glm::vec2 & min, const glm::vec2 & max, std::vector<size_t> & ids) const;
+
+	size_t size() const { return count; }
+	float getCellSize() const { return cellSize; }
+
+	// Heap bytes of the cells, approximating the hash map's node overhead
+	size_t getMemoryUsage() const;
+	// Drop empty cells and excess capacity
+	void compact();
+
+private:
+	uint64_t getKey(int x, int y) const {
+		return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+	}
+	int getCell(float v) const;
+
+	std::unordered_map<uint64_t, std::vector<size_t>> cells;
+	float cellSize = 1;
+	float invCellSize = 1;
+	size_t count = 0;
+};
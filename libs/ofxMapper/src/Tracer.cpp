@@ -0,0 +1,220 @@
+#include "Tracer.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <cstdio>
+
+std::atomic<bool> Tracer::enabled(false);
+
+// Written by the owning thread only. seq is the event index + 1 once complete, and 0 while
+// the slot is being written, so readers can drop slots overwritten under them.
+struct Slot {
+	std::atomic<uint64_t> seq{ 0 };
+	std::atomic<const char *> name{ nullptr };
+	std::atomic<const char *> category{ nullptr };
+	std::atomic<uint64_t> start{ 0 };
+	std::atomic<uint64_t> end{ 0 };
+	std::atomic<uint32_t> tid{ 0 };
+};
+
+struct Tracer::Buffer {
+	std::unique_ptr<Slot[]> slots{ new Slot[bufferSize] };
+	std::atomic<uint64_t> head{ 0 };
+	uint32_t tid = 0;
+	bool inUse = false;
+};
+
+// Buffers outlive their threads and are handed to new ones, so short lived workers
+// don't add a buffer each. Never destroyed, threads may still record during exit.
+struct Tracer::Registry {
+	std::mutex mutex;
+	std::vector<std::unique_ptr<Buffer>> buffers;
+	std::map<uint32_t, std::string> threadNames;
+	uint32_t nextTid = 1;
+	std::atomic<uint64_t> clearTime{ 0 };
+};
+
+//--------------------------------------------------------------
+Tracer::Registry & Tracer::getRegistry() {
+	static Registry * registry = new Registry;
+	return *registry;
+}
+
+//--------------------------------------------------------------
+static std::chrono::steady_clock::time_point getEpoch() {
+	static std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+	return epoch;
+}
+
+//--------------------------------------------------------------
+void Tracer::setEnabled(bool enabled) {
+	getEpoch();
+	Tracer::enabled = enabled;
+}
+
+//--------------------------------------------------------------
+uint64_t Tracer::now() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - getEpoch()).count();
+}
+
+// Buffer of the thread, taken on its first event
+struct Tracer::Holder {
+	Buffer * buffer = nullptr;
+	std::string threadName;
+	~Holder() {
+		if (buffer) {
+			std::lock_guard<std::mutex> lock(getRegistry().mutex);
+			buffer->inUse = false;
+		}
+	}
+};
+
+//--------------------------------------------------------------
+Tracer::Holder & Tracer::getHolder() {
+	static thread_local Holder holder;
+	return holder;
+}
+
+//--------------------------------------------------------------
+Tracer::Buffer & Tracer::getBuffer() {
+	Holder & holder = getHolder();
+	if (!holder.buffer) {
+		Registry & registry = getRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		for (auto & b : registry.buffers) {
+			if (!b->inUse) {
+				holder.buffer = b.get();
+				break;
+			}
+		}
+		if (!holder.buffer) {
+			registry.buffers.emplace_back(new Buffer);
+			holder.buffer = registry.buffers.back().get();
+		}
+		holder.buffer->inUse = true;
+		holder.buffer->tid = registry.nextTid++;
+		if (!holder.threadName.empty())
+			registry.threadNames[holder.buffer->tid] = holder.threadName;
+	}
+	return *holder.buffer;
+}
+
+//--------------------------------------------------------------
+void Tracer::setThreadName(const std::string & name) {
+	Holder & holder = getHolder();
+	holder.threadName = name;
+	if (holder.buffer) {
+		Registry & registry = getRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		registry.threadNames[holder.buffer->tid] = name;
+	}
+}
+
+//--------------------------------------------------------------
+void Tracer::record(const char * name, const char * category, uint64_t start, uint64_t end) {
+	Buffer & buffer = getBuffer();
+	uint64_t i = buffer.head.load(std::memory_order_relaxed);
+	Slot & slot = buffer.slots[i % bufferSize];
+
+	slot.seq.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.name.store(name, std::memory_order_relaxed);
+	slot.category.store(category, std::memory_order_relaxed);
+	slot.start.store(start, std::memory_order_relaxed);
+	slot.end.store(end, std::memory_order_relaxed);
+	slot.tid.store(buffer.tid, std::memory_order_relaxed);
+	slot.seq.store(i + 1, std::memory_order_release);
+
+	buffer.head.store(i + 1, std::memory_order_release);
+}
+
+//--------------------------------------------------------------
+static void writeString(std::ostream & out, const char * s) {
+	out << '"';
+	for (; s && *s; s++) {
+		if (*s == '"' || *s == '\\')
+			out << '\\';
+		if ((unsigned char)*s >= 0x20)
+			out << *s;
+	}
+	out << '"';
+}
+
+//--------------------------------------------------------------
+static void writeMicros(std::ostream & out, uint64_t ns) {
+	char s[32];
+	snprintf(s, sizeof(s), "%llu.%03u", (unsigned long long)(ns / 1000), (unsigned)(ns % 1000));
+	out << s;
+}
+
+//--------------------------------------------------------------
+void Tracer::write(std::ostream & out) {
+	Registry & registry = getRegistry();
+	uint64_t clearTime = registry.clearTime.load();
+
+	std::vector<Buffer *> buffers;
+	std::map<uint32_t, std::string> threadNames;
+	{
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		for (auto & b : registry.buffers)
+			buffers.push_back(b.get());
+		threadNames = registry.threadNames;
+	}
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"ofxMapper\"}}";
+	for (auto & t : threadNames) {
+		out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t.first << ",\"args\":{\"name\":";
+		writeString(out, t.second.c_str());
+		out << "}}";
+	}
+
+	for (Buffer * buffer : buffers) {
+		uint64_t head = buffer->head.load(std::memory_order_acquire);
+		uint64_t first = head > bufferSize ? head - bufferSize : 0;
+		for (uint64_t i = first; i < head; i++) {
+			Slot & slot = buffer->slots[i % bufferSize];
+			uint64_t seq = slot.seq.load(std::memory_order_acquire);
+			const char * name = slot.name.load(std::memory_order_relaxed);
+			const char * category = slot.category.load(std::memory_order_relaxed);
+			uint64_t start = slot.start.load(std::memory_order_relaxed);
+			uint64_t end = slot.end.load(std::memory_order_relaxed);
+			uint32_t tid = slot.tid.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			// Overwritten while reading
+			if (seq != i + 1 || slot.seq.load(std::memory_order_relaxed) != seq)
+				continue;
+			if (start < clearTime)
+				continue;
+
+			out << ",\n{\"name\":";
+			writeString(out, name);
+			out << ",\"cat\":";
+			writeString(out, category);
+			out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid << ",\"ts\":";
+			writeMicros(out, start);
+			out << ",\"dur\":";
+			writeMicros(out, end > start ? end - start : 0);
+			out << "}";
+		}
+	}
+	out << "\n]}\n";
+}
+
+//--------------------------------------------------------------
+bool Tracer::save(const std::string & filePath) {
+	std::ofstream file(filePath);
+	if (!file)
+		return false;
+	write(file);
+	return (bool)file;
+}
+
+//--------------------------------------------------------------
+void Tracer::clear() {
+	getRegistry().clearTime = now();
+}
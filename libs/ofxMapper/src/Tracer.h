@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <ostream>
+
+// Timeline of scoped events for chrome://tracing or Perfetto. Each thread records into
+// its own ring buffer without locking, the oldest events being overwritten. Buffers are
+// read on demand and written as Chrome trace JSON. Names and categories must be string
+// literals, only the pointers are stored.
+class Tracer {
+public:
+	// Events per thread
+	static const size_t bufferSize = 16384;
+
+	static void setEnabled(bool enabled);
+	static bool isEnabled() {
+		return enabled.load(std::memory_order_relaxed);
+	}
+
+	// Name the calling thread in the timeline. Cheap while tracing is disabled.
+	static void setThreadName(const std::string & name);
+
+	// Nanoseconds since the tracer was first used
+	static uint64_t now();
+	static void record(const char * name, const char * category, uint64_t start, uint64_t end);
+
+	// Events recorded since the last clear(), as Chrome trace JSON
+	static void write(std::ostream & out);
+	static bool save(const std::string & filePath);
+	static void clear();
+
+private:
+	struct Buffer;
+	struct Registry;
+	struct Holder;
+	static Holder & getHolder();
+	static Buffer & getBuffer();
+	static Registry & getRegistry();
+
+	static std::atomic<bool> enabled;
+};
+
+// Records the time until the end of the scope, if tracing is enabled
+class TraceScope {
+public:
+	TraceScope(const char * name, const char * category = "ofxMapper") : name(name), category(category), active(Tracer::isEnabled()) {
+		if (active)
+			start = Tracer::now();
+	}
+	~TraceScope() {
+		if (active)
+			Tracer::record(name, category, start, Tracer::now());
+	}
+
+private:
+	const char * name;
+	const char * category;
+	bool active;
+	uint64_t start = 0;
+};
@@ -0,0 +1,49 @@
+#include "UniqueId.h"
+
+#include <random>
+
+//--------------------------------------------------------------
+UniqueId UniqueId::create() {
+	static thread_local std::mt19937_64 engine(std::random_device{}());
+	uint64_t value;
+	do {
+		value = engine();
+	} while (value == 0);
+	return UniqueId(value);
+}
+
+//--------------------------------------------------------------
+UniqueId UniqueId::parse(const std::string & s) {
+	if (s.empty())
+		return UniqueId();
+
+	uint64_t value = 0;
+	bool decimal = s.size() <= 20;
+	for (char c : s) {
+		if (c < '0' || c > '9') {
+			decimal = false;
+			break;
+		}
+		uint64_t digit = c - '0';
+		if (value > (UINT64_MAX - digit) / 10) {
+			decimal = false;
+			break;
+		}
+		value = value * 10 + digit;
+	}
+	if (decimal)
+		return UniqueId(value);
+
+	// 64 bit FNV-1a
+	value = 14695981039346656037ull;
+	for (unsigned char c : s) {
+		value ^= c;
+		value *= 1099511628211ull;
+	}
+	return UniqueId(value ? value : 1);
+}
+
+//--------------------------------------------------------------
+std::string UniqueId::toString() const {
+	return std::to_string(value);
+}
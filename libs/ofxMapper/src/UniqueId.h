@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <ostream>
+#include <unordered_map>
+
+// 64 bit id of a screen, slice or mask. Written to files as a decimal string, 0 is no id.
+class UniqueId {
+public:
+	UniqueId() {}
+	explicit UniqueId(uint64_t value) : value(value) {}
+
+	// Random non-zero id
+	static UniqueId create();
+	// Decimal ids as written by Resolume and ofxMapper. Anything else is hashed, so
+	// parsing the same string always gives the same id.
+	static UniqueId parse(const std::string & s);
+	std::string toString() const;
+
+	bool isValid() const { return value != 0; }
+	bool operator==(const UniqueId & id) const { return value == id.value; }
+	bool operator!=(const UniqueId & id) const { return value != id.value; }
+
+	uint64_t value = 0;
+};
+
+inline std::ostream & operator<<(std::ostream & os, const UniqueId & id) {
+	return os << id.value;
+}
+
+namespace std {
+	template<> struct hash<UniqueId> {
+		size_t operator()(const UniqueId & id) const {
+			return std::hash<uint64_t>()(id.value);
+		}
+	};
+}
+
+// Hash index from id to position in a vector of shared pointers to objects with a
+// uniqueId member. Owners insert right after appending and erase before removing.
+// Hits are checked against the vector, so items removed from it behind the index's
+// back are never returned. Misses rebuild the index once, later misses are answered
+// from it until the vector's size changes. Call rebuild() after changing ids directly.
+template<typename T>
+class UniqueIdIndex {
+public:
+	std::shared_ptr<T> find(const std::vector<std::shared_ptr<T>> & items, const UniqueId & id) {
+		auto it = index.find(id);
+		if (it != index.end()) {
+			if (it->second < items.size() && items[it->second]->uniqueId == id)
+				return items[it->second];
+		}
+		else if (exact && indexedSize == items.size()) {
+			return NULL;
+		}
+		rebuild(items);
+		it = index.find(id);
+		return it != index.end() ? items[it->second] : NULL;
+	}
+
+	void insert(const std::shared_ptr<T> & item) {
+		index[item->uniqueId] = indexedSize++;
+	}
+
+	void erase(const std::shared_ptr<T> & item) {
+		auto it = index.find(item->uniqueId);
+		if (it == index.end())
+			return;
+		index.erase(it);
+		indexedSize--;
+		// Later positions shift down, hits on them fail the check and rebuild
+		exact = false;
+	}
+
+	void clear() {
+		index.clear();
+		indexedSize = 0;
+		exact = true;
+	}
+
+	void rebuild(const std::vector<std::shared_ptr<T>> & items) {
+		index.clear();
+		for (size_t i = 0; i < items.size(); i++) {
+			index[items[i]->uniqueId] = i;
+		}
+		indexedSize = items.size();
+		exact = true;
+	}
+
+private:
+	std::unordered_map<UniqueId, size_t> index;
+	size_t indexedSize = 0;
+	// Every item is indexed at its position, so a miss means the id isn't there
+	bool exact = true;
+};
@@ -0,0 +1,87 @@
+#include "VertexCodec.h"
+
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+
+#if defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+// Longest shortest-round-trip float, e.g. -1.17549435e-38
+static const size_t maxFloatChars = 16;
+
+//--------------------------------------------------------------
+static char * writeFloat(char * p, float value) {
+#if defined(__cpp_lib_to_chars)
+	return std::to_chars(p, p + maxFloatChars, value).ptr;
+#else
+	char s[32];
+	int n = snprintf(s, sizeof(s), "%.9g", value);
+	memcpy(p, s, n);
+	return p + n;
+#endif
+}
+
+//--------------------------------------------------------------
+static char * writeString(char * p, const char * s, size_t n) {
+	memcpy(p, s, n);
+	return p + n;
+}
+
+//--------------------------------------------------------------
+void VertexCodec::encode(const std::string & tag, const glm::vec2 * vertices, size_t n, std::string & out) {
+	static const char open[] = "<v x=\"";
+	static const char middle[] = "\" y=\"";
+	static const char close[] = "\"/>";
+	const size_t vertexChars = sizeof(open) + sizeof(middle) + sizeof(close) - 3 + 2 * maxFloatChars;
+
+	size_t start = out.size();
+	out.resize(start + 2 * tag.size() + 5 + n * vertexChars);
+	char * p = &out[start];
+
+	*p++ = '<';
+	p = writeString(p, tag.data(), tag.size());
+	*p++ = '>';
+	for (size_t i = 0; i < n; i++) {
+		p = writeString(p, open, sizeof(open) - 1);
+		p = writeFloat(p, vertices[i].x);
+		p = writeString(p, middle, sizeof(middle) - 1);
+		p = writeFloat(p, vertices[i].y);
+		p = writeString(p, close, sizeof(close) - 1);
+	}
+	*p++ = '<';
+	*p++ = '/';
+	p = writeString(p, tag.data(), tag.size());
+	*p++ = '>';
+
+	out.resize(p - out.data());
+}
+
+//--------------------------------------------------------------
+bool VertexCodec::parseFloat(const char * begin, const char * end, float & value) {
+	const char * p = begin;
+	while (p < end && isspace((unsigned char)*p))
+		p++;
+	if (p < end && *p == '+')
+		p++;
+#if defined(__cpp_lib_to_chars)
+	return std::from_chars(p, end, value).ec == std::errc();
+#else
+	// strtof needs a terminated string
+	char s[64];
+	size_t n = std::min<size_t>(end - p, sizeof(s) - 1);
+	memcpy(s, p, n);
+	s[n] = 0;
+	char * e = NULL;
+	float f = strtof(s, &e);
+	if (e == s)
+		return false;
+	value = f;
+	return true;
+#endif
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "glm/glm.hpp"
+
+// Text encoding of vertex lists in the <v x="" y=""/> layout of Resolume files.
+// Numbers are written with the shortest representation that reads back exactly.
+class VertexCodec {
+public:
+	// Append <tag><v x="" y=""/>...</tag> to out
+	static void encode(const std::string & tag, const glm::vec2 * vertices, size_t n, std::string & out);
+	// Leading whitespace and + are skipped
+	static bool parseFloat(const char * begin, const char * end, float & value);
+	static bool parseFloat(const std::string & s, float & value) {
+		return parseFloat(s.data(), s.data() + s.size(), value);
+	}
+};
@@ -0,0 +1,135 @@
+#include "VertexTransform.h"
+#include <cmath>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VERTEXTRANSFORM_SSE2
+#endif
+
+//--------------------------------------------------------------
+glm::mat3 VertexTransform::getTranslation(const glm::vec2 & delta) {
+	glm::mat3 m(1.f);
+	m[2][0] = delta.x;
+	m[2][1] = delta.y;
+	return m;
+}
+
+//--------------------------------------------------------------
+glm::mat3 VertexTransform::getScale(const glm::vec2 & scale, const glm::vec2 & origin) {
+	glm::mat3 m(1.f);
+	m[0][0] = scale.x;
+	m[1][1] = scale.y;
+	m[2][0] = origin.x - origin.x * scale.x;
+	m[2][1] = origin.y - origin.y * scale.y;
+	return m;
+}
+
+//--------------------------------------------------------------
+glm::mat3 VertexTransform::getRotation(float radians, const glm::vec2 & origin) {
+	float c = std::cos(radians);
+	float s = std::sin(radians);
+	glm::mat3 m(1.f);
+	m[0][0] = c;
+	m[0][1] = s;
+	m[1][0] = -s;
+	m[1][1] = c;
+	m[2][0] = origin.x - c * origin.x + s * origin.y;
+	m[2][1] = origin.y - s * origin.x - c * origin.y;
+	return m;
+}
+
+//--------------------------------------------------------------
+glm::mat3 VertexTransform::getPerspective(const glm::vec2 src[4], const glm::vec2 dst[4]) {
+	// Solve for h00..h21 with h22 = 1, two equations per corner
+	double a[8][9];
+	for (int i = 0; i < 4; i++) {
+		double x = src[i].x, y = src[i].y, u = dst[i].x, v = dst[i].y;
+		double r0[9] = { x, y, 1, 0, 0, 0, -u * x, -u * y, u };
+		double r1[9] = { 0, 0, 0, x, y, 1, -v * x, -v * y, v };
+		for (int j = 0; j < 9; j++) {
+			a[i * 2][j] = r0[j];
+			a[i * 2 + 1][j] = r1[j];
+		}
+	}
+
+	for (int c = 0; c < 8; c++) {
+		int pivot = c;
+		for (int r = c + 1; r < 8; r++) {
+			if (std::abs(a[r][c]) > std::abs(a[pivot][c]))
+				pivot = r;
+		}
+		// Degenerate corners, leave points where they are
+		if (std::abs(a[pivot][c]) < 1e-12)
+			return glm::mat3(1.f);
+		for (int j = 0; j < 9; j++)
+			std::swap(a[c][j], a[pivot][j]);
+		for (int r = 0; r < 8; r++) {
+			if (r == c)
+				continue;
+			double f = a[r][c] / a[c][c];
+			for (int j = c; j < 9; j++)
+				a[r][j] -= f * a[c][j];
+		}
+	}
+
+	double h[8];
+	for (int i = 0; i < 8; i++)
+		h[i] = a[i][8] / a[i][i];
+
+	// glm is column major, m[column][row]
+	glm::mat3 m;
+	m[0][0] = h[0]; m[1][0] = h[1]; m[2][0] = h[2];
+	m[0][1] = h[3]; m[1][1] = h[4]; m[2][1] = h[5];
+	m[0][2] = h[6]; m[1][2] = h[7]; m[2][2] = 1.f;
+	return m;
+}
+
+//--------------------------------------------------------------
+glm::vec2 VertexTransform::apply(const glm::mat3 & m, const glm::vec2 & p) {
+	glm::vec3 q = m * glm::vec3(p, 1.f);
+	return glm::vec2(q) / q.z;
+}
+
+//--------------------------------------------------------------
+void VertexTransform::apply(const glm::mat3 & m, glm::vec2 * points, size_t n) {
+	bool affine = m[0][2] == 0 && m[1][2] == 0 && m[2][2] == 1;
+	size_t i = 0;
+
+#ifdef VERTEXTRANSFORM_SSE2
+	__m128 m00 = _mm_set1_ps(m[0][0]), m10 = _mm_set1_ps(m[1][0]), m20 = _mm_set1_ps(m[2][0]);
+	__m128 m01 = _mm_set1_ps(m[0][1]), m11 = _mm_set1_ps(m[1][1]), m21 = _mm_set1_ps(m[2][1]);
+	__m128 m02 = _mm_set1_ps(m[0][2]), m12 = _mm_set1_ps(m[1][2]), m22 = _mm_set1_ps(m[2][2]);
+
+	float * f = &points[0].x;
+	for (; i + 4 <= n; i += 4, f += 8) {
+		__m128 a = _mm_loadu_ps(f);
+		__m128 b = _mm_loadu_ps(f + 4);
+		__m128 x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 y = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+
+		__m128 tx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m10, y)), m20);
+		__m128 ty = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, x), _mm_mul_ps(m11, y)), m21);
+		if (!affine) {
+			__m128 w = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, x), _mm_mul_ps(m12, y)), m22);
+			tx = _mm_div_ps(tx, w);
+			ty = _mm_div_ps(ty, w);
+		}
+
+		_mm_storeu_ps(f, _mm_unpacklo_ps(tx, ty));
+		_mm_storeu_ps(f + 4, _mm_unpackhi_ps(tx, ty));
+	}
+#endif
+
+	for (; i < n; i++) {
+		glm::vec2 & p = points[i];
+		float x = m[0][0] * p.x + m[1][0] * p.y + m[2][0];
+		float y = m[0][1] * p.x + m[1][1] * p.y + m[2][1];
+		if (!affine) {
+			float w = m[0][2] * p.x + m[1][2] * p.y + m[2][2];
+			x /= w;
+			y /= w;
+		}
+		p = glm::vec2(x, y);
+	}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include "glm/glm.hpp"
+
+// Projective 2D transforms as homogeneous 3x3 matrices, applied in bulk to vertex arrays
+class VertexTransform {
+public:
+	static glm::mat3 getTranslation(const glm::vec2 & delta);
+	static glm::mat3 getScale(const glm::vec2 & scale, const glm::vec2 & origin);
+	static glm::mat3 getRotation(float radians, const glm::vec2 & origin);
+	// Homography mapping the four src corners onto the four dst corners
+	static glm::mat3 getPerspective(const glm::vec2 src[4], const glm::vec2 dst[4]);
+
+	static glm::vec2 apply(const glm::mat3 & m, const glm::vec2 & p);
+	// In place, four points per iteration where SSE2 is available
+	static void apply(const glm::mat3 & m, glm::vec2 * points, size_t n);
+};
@@ -1,6 +1,8 @@
 #pragma once
 
-#include "ofMain.h"
+#include <memory>
+#include <cstddef>
+#include "glm/glm.hpp"
 
 class Vertices {
 public:
@@ -8,7 +10,7 @@ public:
         data = new glm::vec2[w*h];
     }
     ~Vertices() {
-        delete data;
+        delete[] data;
     }
 
     glm::vec2 * data = NULL;
@@ -16,4 +18,4 @@ public:
     size_t height = 0;
 };
 
-typedef shared_ptr<Vertices> VerticesPtr;
+typedef std::shared_ptr<Vertices> VerticesPtr;
@@ -4,6 +4,7 @@
 #include "Vertices.h"
 #include "WarpHandle.h"
 #include "SoftEdge.h"
+#include "MemoryUsage.h"
 
 
 class Warper {
@@ -12,6 +13,8 @@ public:
 	virtual void setVertices(VerticesPtr vertices) = 0;
 
     virtual VerticesPtr subdivide(int cols, int rows) = 0;
+	// Release vertices and geometry while the warper is not in use
+	virtual void clear() = 0;
 
     virtual void updatePatches() = 0;
     virtual void updateTexCoords() = 0;
@@ -28,4 +31,9 @@ public:
 	virtual bool select(const glm::vec2 & p) = 0;
 
 	virtual void moveHandle(WarpHandle & handle, const glm::vec2 & delta) = 0;
+
+	// Add patches, meshes and handles, the vertices are counted by their owner
+	virtual void getMemoryUsage(ofxMapper::MemoryUsage & usage) const = 0;
+	// Shrink buffers to fit, keeping the geometry
+	virtual void compact() = 0;
 };
@@ -0,0 +1,48 @@
+#include "BlendCurve.h"
+#include <cmath>
+#include <cstdio>
+
+// The soft edge lookup must stay within BlendCurve::maxError of the analytic curve over
+// the whole parameter range of SoftEdge: power 0.1 - 7, luminance 0 - 1, gamma 0 - 1.
+int main() {
+	const int samples = 4096;
+	int failures = 0;
+	int numCurves = 0;
+	int numTabulated = 0;
+	float worst = 0;
+
+	for (int p = 1; p <= 70; p++) {
+		for (int a = 0; a <= 10; a++) {
+			for (int g = 0; g <= 10; g++) {
+				float power = p * 0.1f;
+				float luminance = a * 0.1f;
+				float gamma = g * 0.1f;
+				BlendCurve curve(power, luminance, gamma);
+				numCurves++;
+				if (curve.isTabulated())
+					numTabulated++;
+
+				float error = 0;
+				for (int i = 0; i <= samples; i++) {
+					float x = (float)i / samples;
+					error = std::fmax(error, std::fabs(curve.lookup(x) - curve.evaluate(x)));
+				}
+				// Both ends are the steepest for powers below 1
+				for (int k = 1; k < 30; k++) {
+					float x = ldexpf(1.f, -k);
+					error = std::fmax(error, std::fabs(curve.lookup(x) - curve.evaluate(x)));
+					error = std::fmax(error, std::fabs(curve.lookup(1.f - x) - curve.evaluate(1.f - x)));
+				}
+
+				worst = std::fmax(worst, error);
+				if (!(error <= BlendCurve::maxError)) {
+					printf("power %.1f luminance %.1f gamma %.1f: error %.2f / 1024\n", power, luminance, gamma, error * 1024);
+					failures++;
+				}
+			}
+		}
+	}
+
+	printf("%d curves, %d tabulated, worst error %.3f / 1024, %d failed\n", numCurves, numTabulated, worst * 1024, failures);
+	return failures ? 1 : 0;
+}